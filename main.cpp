@@ -6,9 +6,52 @@
  */
 
  #include "serialflex.hpp"
+ #include "serialflex_pipeline.hpp"
+ #include "serialflex_queue.hpp"
+ #include "serialflex_parallel.hpp"
+ #include "serialflex_arq.hpp"
+ #include "serialflex_fec.hpp"
+ #include "serialflex_sim.hpp"
+ #include "serialflex_flow.hpp"
+ #include "serialflex_scheduler.hpp"
+ #if defined(__linux__)
+ #include "serialflex_transport.hpp"
+ #include "serialflex_uring.hpp"
+ #include "serialflex_shm.hpp"
+ #include <pty.h>
+ #include <sys/wait.h>
+ #endif
+ #if defined(__cpp_impl_coroutine)
+ #include "serialflex_coro.hpp"
+ #endif
  #include <iostream>
  #include <iomanip>
  #include <chrono>
+ #include <cstdlib>
+ #include <new>
+ #include <atomic>
+ #include <thread>
+ #include <functional>
+ 
+ //! Global allocation counter used by the allocation benchmarks (Examples 12 and 14).
+ //! Kept out of line so the compiler does not pair the inlined free() with operator new.
+ static std::atomic<size_t> g_allocationCount{0};
+ 
+ [[gnu::noinline]] void* operator new(size_t size) {
+     g_allocationCount++;
+     if (void* ptr = std::malloc(size)) {
+         return ptr;
+     }
+     throw std::bad_alloc();
+ }
+ 
+ [[gnu::noinline]] void operator delete(void* ptr) noexcept {
+     std::free(ptr);
+ }
+ 
+ [[gnu::noinline]] void operator delete(void* ptr, size_t) noexcept {
+     std::free(ptr);
+ }
  
  //! Example custom data structure with serialization support
  struct SensorData {
@@ -60,8 +103,8 @@
          data.timestamp = reader.read<uint32_t>();
          
          uint32_t strLength = reader.read<uint32_t>();
-         auto bytes = reader.readBytes(strLength);
-         data.sensorId = std::string(bytes.begin(), bytes.end());
+         auto bytes = reader.readView(strLength);
+         data.sensorId.assign(reinterpret_cast<const char*>(bytes.data()), bytes.size());
          
          uint32_t readingsLength = reader.read<uint32_t>();
          data.readings.reserve(readingsLength);
@@ -146,12 +189,13 @@
          
          //! Read target name
          uint32_t nameLength = reader.read<uint32_t>();
-         auto nameBytes = reader.readBytes(nameLength);
-         cmd.targetName = std::string(nameBytes.begin(), nameBytes.end());
+         auto nameBytes = reader.readView(nameLength);
+         cmd.targetName.assign(reinterpret_cast<const char*>(nameBytes.data()), nameBytes.size());
          
          //! Read payload
          uint32_t payloadLength = reader.read<uint32_t>();
-         cmd.payload = reader.readBytes(payloadLength);
+         auto payloadBytes = reader.readView(payloadLength);
+         cmd.payload.assign(payloadBytes.begin(), payloadBytes.end());
          
          //! Read parameters
          uint32_t paramCount = reader.read<uint32_t>();
@@ -168,6 +212,18 @@
      }
  };
  
+ //! Constant "RESET motor_controller on device 0x1234" command, framed at compile time.
+ //! Field order follows Command::serialize(): type, deviceId, targetName, payload, parameters.
+ constexpr auto RESET_COMMAND_PAYLOAD = serialflex::serializeConst(
+     Command::CommandType::RESET,
+     uint16_t{0x1234},
+     "motor_controller",
+     uint32_t{0},                                  //! empty payload
+     uint32_t{0}                                   //! no parameters
+ );
+ constexpr auto RESET_COMMAND_FRAME = serialflex::makeConstFrame<0x02, RESET_COMMAND_PAYLOAD>();
+ static_assert(RESET_COMMAND_FRAME.front() == serialflex::PacketFramer::START_BYTE, "Frame built at compile time");
+ 
  //! Helper function to print a byte vector as hex
  void printHex(const std::vector<uint8_t>& data, const std::string& label) {
      std::cout << label << " (" << data.size() << " bytes): ";
@@ -188,11 +244,11 @@
      //! Process each byte one by one (as would happen in a real serial transmission)
      for (uint8_t byte : data) {
          if (receiver.processByte(byte, deframedPacket)) {
-             if (deframedPacket.valid) {
+             if (deframedPacket.valid()) {
                  std::cout << "Received valid packet with ID: " << static_cast<int>(deframedPacket.messageId) << std::endl;
                  std::cout << "Payload size: " << deframedPacket.payload.size() << " bytes" << std::endl;
              } else {
-                 std::cout << "Received invalid packet: " << deframedPacket.errorReason << std::endl;
+                 std::cout << "Received invalid packet: " << deframedPacket.errorReason() << std::endl;
              }
          }
      }
@@ -320,7 +376,7 @@
      //! Deframe the packet
      auto deframed = serialflex::PacketFramer::deframePacket(packet);
      
-     if (deframed.valid) {
+     if (deframed.valid()) {
          std::cout << "Packet is valid." << std::endl;
          std::cout << "Message ID: " << static_cast<int>(deframed.messageId) << std::endl;
          std::cout << "Payload size: " << deframed.payload.size() << " bytes" << std::endl;
@@ -335,7 +391,7 @@
          std::cout << "  Timestamp: " << deserialized.timestamp << std::endl;
          std::cout << "  Sensor ID: " << deserialized.sensorId << std::endl;
      } else {
-         std::cout << "Packet is invalid: " << deframed.errorReason << std::endl;
+         std::cout << "Packet is invalid: " << deframed.errorReason() << std::endl;
      }
      
      //! Simulate a corrupted packet (change a byte in the middle)
@@ -347,11 +403,11 @@
      //! Try to deframe the corrupted packet
      auto deframedCorrupted = serialflex::PacketFramer::deframePacket(corruptedPacket);
      
-     if (deframedCorrupted.valid) {
+     if (deframedCorrupted.valid()) {
          std::cout << "Corrupted packet is valid (This shouldn't happen)." << std::endl;
      } else {
          std::cout << "Corrupted packet is correctly detected as invalid: " 
-                   << deframedCorrupted.errorReason << std::endl;
+                   << deframedCorrupted.errorReason() << std::endl;
      }
      
      //! Demonstrate byte-by-byte processing
@@ -500,6 +556,1424 @@
      std::cout << "Expected CRC-32 IEEE 802.3 (x^32 + x^26 + ... + 1): 0xCBF43926" << std::endl;
  }
  
+ //! Example 8: Compile-time message dispatch
+ void example8_dispatch() {
+     std::cout << "\n=== Example 8: Message Dispatch ===" << std::endl;
+     
+     //! Bind message IDs to payload types once
+     using Registry = serialflex::MessageRegistry<
+         serialflex::Message<0x01, SensorData>,
+         serialflex::Message<0x02, Command>
+     >;
+     
+     //! Build a byte stream carrying both message types
+     SensorData sensorData = {21.0f, 40.0f, 1234, "SENSOR_002", {1, 2, 3}};
+     Command cmd;
+     cmd.type = Command::CommandType::RESET;
+     cmd.deviceId = 0x1234;
+     cmd.targetName = "pump";
+     
+     std::vector<uint8_t> stream = Registry::createPacket(sensorData);
+     auto cmdPacket = Registry::createPacket(cmd);
+     stream.insert(stream.end(), cmdPacket.begin(), cmdPacket.end());
+     
+     //! One handler object covers every registered type
+     auto handler = serialflex::overloaded{
+         [](const SensorData& data) {
+             std::cout << "Dispatched SensorData from " << data.sensorId << std::endl;
+         },
+         [](const Command& command) {
+             std::cout << "Dispatched Command for device 0x" << std::hex << command.deviceId
+                       << std::dec << std::endl;
+         }
+     };
+     
+     serialflex::PacketReceiver receiver;
+     serialflex::DeframedPacket packet;
+     for (uint8_t byte : stream) {
+         if (receiver.processByte(byte, packet)) {
+             auto result = Registry::dispatch(packet, handler);
+             if (result != serialflex::DispatchResult::Handled) {
+                 std::cout << "Dispatch failed for ID " << static_cast<int>(packet.messageId) << std::endl;
+             }
+         }
+     }
+ }
+ 
+ //! Example 9: Fragmenting a large payload
+ void example9_fragmentation() {
+     std::cout << "\n=== Example 9: Fragmentation ===" << std::endl;
+     
+     //! A 100 KB "firmware image" is far beyond the 16-bit length field and the receiver cap
+     std::vector<uint8_t> image(100 * 1024);
+     for (size_t i = 0; i < image.size(); i++) {
+         image[i] = static_cast<uint8_t>(i * 31 + (i >> 8));
+     }
+     
+     constexpr uint8_t FRAGMENT_ID = 0xF0;
+     constexpr uint8_t FIRMWARE_ID = 0x10;
+     
+     serialflex::Fragmenter fragmenter(FRAGMENT_ID, 512);
+     serialflex::Reassembler reassembler(image.size());
+     serialflex::PacketReceiver receiver;
+     serialflex::DeframedPacket packet;
+     
+     size_t fragments = 0;
+     bool complete = false;
+     fragmenter.fragment(FIRMWARE_ID, image, [&](const std::vector<uint8_t>& frame) {
+         fragments++;
+         for (uint8_t byte : frame) {
+             if (receiver.processByte(byte, packet) && packet.messageId == FRAGMENT_ID) {
+                 complete = reassembler.processFragment(packet) == serialflex::Reassembler::Status::Complete;
+             }
+         }
+     });
+     
+     auto message = reassembler.message();
+     bool intact = complete && std::equal(message.begin(), message.end(), image.begin(), image.end());
+     std::cout << "Sent " << image.size() << " bytes in " << fragments << " fragments" << std::endl;
+     std::cout << "Reassembled message ID " << static_cast<int>(reassembler.messageId())
+               << ": " << (intact ? "intact" : "corrupted") << std::endl;
+ }
+ 
+ //! Example 10: Preempting bulk frames with urgent commands
+ void example10_preemption() {
+     std::cout << "\n=== Example 10: Frame Preemption ===" << std::endl;
+     
+     constexpr double BYTES_PER_MS = 115200.0 / 10.0 / 1000.0; //! 8N1 UART at 115200 baud
+     constexpr size_t UART_FIFO = 16;
+     
+     serialflex::PreemptiveTransmitter transmitter;
+     serialflex::PreemptiveReceiver receiver;
+     serialflex::DeframedPacket packet;
+     
+     //! Several 1 KB telemetry frames keep the link busy
+     std::vector<uint8_t> telemetry(1000, 0x55);
+     for (int i = 0; i < 4; i++) {
+         transmitter.queueBulk(serialflex::PacketFramer::framePacket(0x01, telemetry));
+     }
+     
+     Command cmd;
+     cmd.type = Command::CommandType::RESET;
+     cmd.deviceId = 0x1234;
+     cmd.targetName = "motor_controller";
+     
+     size_t bytesSent = 0;
+     size_t commandQueuedAt = 0;
+     size_t worstLatencyBytes = 0;
+     uint8_t chunk[UART_FIFO];
+     
+     while (!transmitter.idle()) {
+         //! An emergency command shows up every 700 bytes of link time
+         if (bytesSent % 700 < UART_FIFO && commandQueuedAt == 0) {
+             transmitter.queueExpress(serialflex::createPacket(0x02, cmd));
+             commandQueuedAt = bytesSent + 1;
+         }
+         
+         size_t count = transmitter.nextChunk(chunk, UART_FIFO);
+         for (size_t i = 0; i < count; i++) {
+             bytesSent++;
+             if (receiver.processByte(chunk[i], packet) && packet.valid() && packet.messageId == 0x02) {
+                 worstLatencyBytes = std::max(worstLatencyBytes, bytesSent - (commandQueuedAt - 1));
+                 commandQueuedAt = 0;
+             }
+         }
+     }
+     
+     std::cout << "Worst command latency: " << worstLatencyBytes << " bytes ("
+               << worstLatencyBytes / BYTES_PER_MS << " ms at 115200 baud)" << std::endl;
+     std::cout << "A 1 KB telemetry frame alone takes " << 1007 / BYTES_PER_MS << " ms" << std::endl;
+ }
+ 
+ //! Example 11: Compile-time constant frames
+ void example11_constFrames() {
+     std::cout << "\n=== Example 11: Constant Frames ===" << std::endl;
+     
+     std::vector<uint8_t> constFrame(RESET_COMMAND_FRAME.begin(), RESET_COMMAND_FRAME.end());
+     printHex(constFrame, "Compile-time RESET frame");
+     
+     //! The same command built at runtime produces identical bytes
+     Command cmd;
+     cmd.type = Command::CommandType::RESET;
+     cmd.deviceId = 0x1234;
+     cmd.targetName = "motor_controller";
+     auto runtimeFrame = serialflex::createPacket(0x02, cmd);
+     
+     bool same = serialflex::matchesFrame(runtimeFrame, RESET_COMMAND_FRAME);
+     std::cout << "Runtime frame matches constant frame: " << (same ? "yes" : "no") << std::endl;
+ }
+ 
+ //! Example 12: Allocations and moves when decoding
+ void example12_decodeAllocations() {
+     std::cout << "\n=== Example 12: Decode Allocations ===" << std::endl;
+     
+     constexpr int testCount = 10000;
+     
+     //! SensorData owns exactly two heap buffers: sensorId and readings
+     SensorData sensorData = {
+         22.5f, 65.0f, 1700000000u, "SENSOR_LONG_IDENTIFIER_0001", {1024, 2048, 4096, 8192, 16384}
+     };
+     auto packet = serialflex::createPacket(0x01, sensorData);
+     
+     //! Pair-returning wrapper: result is moved, never copied
+     size_t before = g_allocationCount;
+     auto startPair = std::chrono::high_resolution_clock::now();
+     for (int i = 0; i < testCount; i++) {
+         auto [success, decoded] = serialflex::parsePacket<SensorData>(packet);
+         (void)success;
+     }
+     auto endPair = std::chrono::high_resolution_clock::now();
+     double pairAllocs = static_cast<double>(g_allocationCount - before) / testCount;
+     
+     //! Out-parameter form into a reused object
+     SensorData reused;
+     before = g_allocationCount;
+     auto startOut = std::chrono::high_resolution_clock::now();
+     for (int i = 0; i < testCount; i++) {
+         serialflex::parsePacket(packet, reused);
+     }
+     auto endOut = std::chrono::high_resolution_clock::now();
+     double outAllocs = static_cast<double>(g_allocationCount - before) / testCount;
+     
+     auto pairTime = std::chrono::duration_cast<std::chrono::microseconds>(endPair - startPair).count();
+     auto outTime = std::chrono::duration_cast<std::chrono::microseconds>(endOut - startOut).count();
+     
+     std::cout << "Owned buffers in SensorData: 2" << std::endl;
+     std::cout << "  parsePacket<T>(packet):      " << pairAllocs << " allocations, "
+               << pairTime / static_cast<double>(testCount) << " µs per operation" << std::endl;
+     std::cout << "  parsePacket(packet, out):    " << outAllocs << " allocations, "
+               << outTime / static_cast<double>(testCount) << " µs per operation" << std::endl;
+ }
+ 
+ void example13_receivePipeline() {
+     std::cout << "\n=== Example 13: Multi-threaded Receive Pipeline ===" << std::endl;
+     
+     using Registry = serialflex::MessageRegistry<
+         serialflex::Message<0x01, SensorData>,
+         serialflex::Message<0x02, Command>
+     >;
+     
+     constexpr size_t linkCount = 16;
+     constexpr uint32_t packetsPerLink = 2000;
+     
+     //! Each link carries SensorData numbered by timestamp, so ordering can be checked
+     std::vector<std::vector<uint8_t>> streams(linkCount);
+     for (size_t link = 0; link < linkCount; link++) {
+         for (uint32_t seq = 0; seq < packetsPerLink; seq++) {
+             SensorData data = {20.0f, 50.0f, seq, "LINK", {static_cast<uint16_t>(link)}};
+             auto packet = Registry::createPacket(data);
+             streams[link].insert(streams[link].end(), packet.begin(), packet.end());
+         }
+     }
+     
+     //! Per-link state is only touched by the worker that owns the link
+     std::vector<uint32_t> expected(linkCount, 0);
+     std::vector<uint32_t> outOfOrder(linkCount, 0);
+     auto handler = serialflex::overloaded{
+         [&](size_t link, const SensorData& data) {
+             if (data.timestamp != expected[link]) {
+                 outOfOrder[link]++;
+             }
+             expected[link] = data.timestamp + 1;
+         },
+         [](size_t, const Command&) {}
+     };
+     
+     serialflex::ReceivePipeline<Registry, decltype(handler)> pipeline(linkCount, handler);
+     
+     //! A single reader thread feeding every link in small chunks, as an I/O loop would
+     constexpr size_t chunkSize = 256;
+     auto start = std::chrono::high_resolution_clock::now();
+     std::thread reader([&] {
+         for (size_t offset = 0; ; offset += chunkSize) {
+             bool more = false;
+             for (size_t link = 0; link < linkCount; link++) {
+                 const auto& stream = streams[link];
+                 if (offset < stream.size()) {
+                     size_t count = std::min(chunkSize, stream.size() - offset);
+                     pipeline.submit(link, serialflex::ByteSpan(stream.data() + offset, count));
+                     more = true;
+                 }
+             }
+             if (!more) {
+                 break;
+             }
+         }
+     });
+     reader.join();
+     pipeline.stop();
+     auto end = std::chrono::high_resolution_clock::now();
+     
+     uint64_t packets = 0;
+     uint64_t errors = 0;
+     uint32_t violations = 0;
+     for (size_t link = 0; link < linkCount; link++) {
+         auto stats = pipeline.stats(link);
+         packets += stats.packets;
+         errors += stats.frameErrors + stats.dispatchErrors;
+         violations += outOfOrder[link];
+     }
+     
+     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+     std::cout << "Workers: " << pipeline.workerCount() << ", links: " << linkCount << std::endl;
+     std::cout << "Packets handled: " << packets << " of " << linkCount * packetsPerLink
+               << " (" << errors << " errors, " << violations << " out of order)" << std::endl;
+     std::cout << "Throughput: " << (duration > 0 ? packets * 1000000 / duration : 0) << " packets/s" << std::endl;
+ }
+
+ void example14_frameHandoff() {
+     std::cout << "\n=== Example 14: Lock-free Frame Handoff ===" << std::endl;
+     
+     constexpr uint32_t packetCount = 100000;
+     constexpr uint8_t counterId = 0x10;
+     
+     std::vector<uint8_t> stream;
+     for (uint32_t seq = 0; seq < packetCount; seq++) {
+         auto packet = serialflex::createPacket(counterId, seq);
+         stream.insert(stream.end(), packet.begin(), packet.end());
+     }
+     
+     //! Everything the handoff needs is allocated up front
+     serialflex::FramePool pool(256, 64);
+     serialflex::SpscQueue<serialflex::FrameDescriptor, serialflex::FutexWait> queue(128);
+     
+     uint32_t received = 0;
+     uint32_t outOfOrder = 0;
+     std::thread consumer([&] {
+         serialflex::FrameDescriptor batch[32];
+         while (size_t count = queue.pop(batch, 32)) {
+             for (size_t i = 0; i < count; i++) {
+                 auto value = serialflex::deserialize<uint32_t>(pool.payload(batch[i]));
+                 if (value != received) {
+                     outOfOrder++;
+                 }
+                 received++;
+                 pool.release(batch[i].buffer);
+             }
+         }
+     });
+     
+     //! Receive loop: frame bytes, park payloads in pooled buffers, pass descriptors on
+     size_t allocationsBefore = g_allocationCount;
+     auto start = std::chrono::high_resolution_clock::now();
+     serialflex::PacketReceiver receiver;
+     serialflex::DeframedPacket packet;
+     for (uint8_t byte : stream) {
+         if (receiver.processByte(byte, packet) && packet.valid()) {
+             serialflex::FrameDescriptor frame;
+             while (!pool.tryStore(packet, frame)) {
+                 std::this_thread::yield(); //! All buffers in flight: let the consumer catch up
+             }
+             queue.push(frame);
+         }
+     }
+     queue.close();
+     consumer.join();
+     auto end = std::chrono::high_resolution_clock::now();
+     size_t allocations = g_allocationCount - allocationsBefore;
+     
+     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+     std::cout << "Frames handed off: " << received << " (" << outOfOrder << " out of order)" << std::endl;
+     std::cout << "Heap allocations during transfer: " << allocations << std::endl;
+     std::cout << "Throughput: " << (duration > 0 ? uint64_t(received) * 1000000 / duration : 0) << " frames/s" << std::endl;
+ }
+
+ void example15_multiStream() {
+     std::cout << "\n=== Example 15: Multi-stream Receiver ===" << std::endl;
+     
+     constexpr uint32_t streamCount = 10000;
+     constexpr uint32_t packetsPerStream = 20;
+     constexpr size_t chunkSize = 48;
+     
+     //! Every stream carries numbered SensorData frames
+     std::vector<std::vector<uint8_t>> streams(streamCount);
+     for (uint32_t stream = 0; stream < streamCount; stream++) {
+         for (uint32_t seq = 0; seq < packetsPerStream; seq++) {
+             SensorData data = {20.0f, 50.0f, seq, "DEV", {static_cast<uint16_t>(stream), 1, 2}};
+             auto packet = serialflex::createPacket(0x01, data);
+             streams[stream].insert(streams[stream].end(), packet.begin(), packet.end());
+         }
+     }
+     
+     //! Interleave small chunks across all streams, as a socket poller would deliver them
+     std::vector<serialflex::StreamChunk> batch;
+     for (size_t offset = 0; ; offset += chunkSize) {
+         size_t before = batch.size();
+         for (uint32_t stream = 0; stream < streamCount; stream++) {
+             const auto& bytes = streams[stream];
+             if (offset < bytes.size()) {
+                 size_t count = std::min(chunkSize, bytes.size() - offset);
+                 batch.push_back({stream, serialflex::ByteSpan(bytes.data() + offset, count)});
+             }
+         }
+         if (batch.size() == before) {
+             break;
+         }
+     }
+     
+     //! Baseline: one PacketReceiver object per stream
+     std::vector<std::unique_ptr<serialflex::PacketReceiver>> receivers;
+     for (uint32_t stream = 0; stream < streamCount; stream++) {
+         receivers.push_back(std::make_unique<serialflex::PacketReceiver>());
+     }
+     uint64_t baselinePackets = 0;
+     serialflex::DeframedPacket packet;
+     auto startBaseline = std::chrono::high_resolution_clock::now();
+     for (const auto& chunk : batch) {
+         auto& receiver = *receivers[chunk.stream];
+         for (uint8_t byte : chunk.data) {
+             if (receiver.processByte(byte, packet) && packet.valid()) {
+                 baselinePackets++;
+             }
+         }
+     }
+     auto endBaseline = std::chrono::high_resolution_clock::now();
+     
+     //! Struct-of-arrays receiver over the same batch
+     serialflex::MultiStreamReceiver multi(streamCount);
+     std::vector<uint32_t> expected(streamCount, 0);
+     uint64_t packets = 0;
+     uint64_t outOfOrder = 0;
+     auto startMulti = std::chrono::high_resolution_clock::now();
+     multi.processBatch(batch, [&](const serialflex::StreamPacket& frame) {
+         if (!frame.valid()) {
+             return;
+         }
+         auto data = serialflex::deserialize<SensorData>(frame.payload);
+         if (data.timestamp != expected[frame.stream] || data.readings[0] != frame.stream) {
+             outOfOrder++;
+         }
+         expected[frame.stream] = data.timestamp + 1;
+         packets++;
+     });
+     auto endMulti = std::chrono::high_resolution_clock::now();
+     
+     auto baselineTime = std::chrono::duration_cast<std::chrono::microseconds>(endBaseline - startBaseline).count();
+     auto multiTime = std::chrono::duration_cast<std::chrono::microseconds>(endMulti - startMulti).count();
+     std::cout << "Streams: " << streamCount << ", chunks: " << batch.size() << std::endl;
+     std::cout << "PacketReceiver per stream: " << baselinePackets << " frames in " << baselineTime
+               << " µs, " << sizeof(serialflex::PacketReceiver) << " bytes of state per stream" << std::endl;
+     std::cout << "MultiStreamReceiver:       " << packets << " frames decoded in " << multiTime << " µs, "
+               << serialflex::MultiStreamReceiver::STATE_BYTES_PER_STREAM << " bytes of state per stream, "
+               << multi.bufferCount() << " pooled payload buffers" << std::endl;
+     std::cout << "Out of order: " << outOfOrder << std::endl;
+ }
+
+ void example16_parallelCapture() {
+     std::cout << "\n=== Example 16: Parallel Capture Parsing ===" << std::endl;
+     
+     //! A capture of numbered frames with bursts of line noise in between
+     constexpr uint32_t frameCount = 400000;
+     std::vector<uint8_t> capture;
+     uint32_t noise = 12345;
+     for (uint32_t seq = 0; seq < frameCount; seq++) {
+         SensorData data = {20.0f, 50.0f, seq, "CAP", {0x7E, 0x7D, static_cast<uint16_t>(seq)}};
+         auto packet = serialflex::createPacket(0x01, data);
+         capture.insert(capture.end(), packet.begin(), packet.end());
+         if (seq % 97 == 0) {
+             for (int i = 0; i < 16; i++) {
+                 noise = noise * 1103515245 + 12345;
+                 capture.push_back(static_cast<uint8_t>(noise >> 16));
+             }
+         }
+     }
+     
+     auto decodeTimestamp = [](const serialflex::CapturedFrame& frame) {
+         return serialflex::deserialize<SensorData>(frame.payload).timestamp;
+     };
+     
+     //! Single-threaded reference: validate, unstuff and decode in one pass
+     auto startSerial = std::chrono::high_resolution_clock::now();
+     std::vector<uint32_t> serial;
+     serialflex::PayloadBuffer payload;
+     auto serialSummary = serialflex::PacketFramer::validateFrames(capture, [&](const serialflex::FrameView& view) {
+         if (view.valid()) {
+             serialflex::PacketFramer::unstuffPayload(view, payload);
+             serial.push_back(serialflex::deserialize<SensorData>(payload).timestamp);
+         }
+     });
+     auto endSerial = std::chrono::high_resolution_clock::now();
+     
+     serialflex::ThreadPool pool;
+     auto startParallel = std::chrono::high_resolution_clock::now();
+     auto parallel = serialflex::parseCapture(capture, pool, decodeTimestamp, 256 * 1024);
+     auto endParallel = std::chrono::high_resolution_clock::now();
+     
+     auto serialTime = std::chrono::duration_cast<std::chrono::microseconds>(endSerial - startSerial).count();
+     auto parallelTime = std::chrono::duration_cast<std::chrono::microseconds>(endParallel - startParallel).count();
+     std::cout << "Capture: " << capture.size() / 1024 << " KB, " << serialSummary.validFrames << " valid frames, "
+               << serialSummary.invalidFrames << " rejected candidates" << std::endl;
+     std::cout << "Serial:   " << serialTime << " µs" << std::endl;
+     std::cout << "Parallel: " << parallelTime << " µs on " << pool.threadCount() << " threads" << std::endl;
+     std::cout << "Results identical: " << (parallel.values == serial &&
+                                            parallel.summary.validFrames == serialSummary.validFrames &&
+                                            parallel.summary.invalidFrames == serialSummary.invalidFrames ? "yes" : "no")
+               << std::endl;
+ }
+
+ void example17_batchEncoding() {
+     std::cout << "\n=== Example 17: Parallel Batch Encoding ===" << std::endl;
+     
+     using Registry = serialflex::MessageRegistry<
+         serialflex::Message<0x01, SensorData>,
+         serialflex::Message<0x02, Command>
+     >;
+     
+     constexpr uint32_t messageCount = 100000;
+     std::vector<SensorData> readings;
+     readings.reserve(messageCount);
+     for (uint32_t seq = 0; seq < messageCount; seq++) {
+         readings.push_back({20.0f + seq % 10, 50.0f, seq, "EXPORT", {1, 2, 3, 0x7E}});
+     }
+     
+     //! Serial baseline: one createPacket per message, concatenated
+     auto startSerial = std::chrono::high_resolution_clock::now();
+     std::vector<uint8_t> serial;
+     for (const auto& data : readings) {
+         auto packet = serialflex::createPacket(0x01, data);
+         serial.insert(serial.end(), packet.begin(), packet.end());
+     }
+     auto endSerial = std::chrono::high_resolution_clock::now();
+     
+     serialflex::ThreadPool pool;
+     auto startBatch = std::chrono::high_resolution_clock::now();
+     serialflex::PacketBatch batch = serialflex::createPackets(0x01, readings, pool);
+     auto endBatch = std::chrono::high_resolution_clock::now();
+     
+     //! Mixed batch: IDs come from the registry
+     std::vector<std::variant<SensorData, Command>> mixed = {
+         readings[0],
+         Command{Command::CommandType::GET, 0x1234, "status", {}, {}},
+         readings[1]
+     };
+     serialflex::PacketBatch mixedBatch = serialflex::createPackets<Registry>(mixed, pool);
+     
+     auto serialTime = std::chrono::duration_cast<std::chrono::microseconds>(endSerial - startSerial).count();
+     auto batchTime = std::chrono::duration_cast<std::chrono::microseconds>(endBatch - startBatch).count();
+     std::cout << "Serial createPacket loop: " << serialTime << " µs" << std::endl;
+     std::cout << "createPackets:            " << batchTime << " µs on " << pool.threadCount() << " threads, "
+               << batch.size() << " packets in one " << batch.bytes.size() / 1024 << " KB buffer" << std::endl;
+     std::cout << "Output identical: " << (batch.bytes == serial ? "yes" : "no") << std::endl;
+     std::cout << "Mixed batch IDs:";
+     for (size_t i = 0; i < mixedBatch.size(); i++) {
+         std::cout << " " << static_cast<int>(mixedBatch.packet(i)[1]);
+     }
+     std::cout << std::endl;
+ }
+
+ #if defined(__linux__)
+ void example18_epollTransport() {
+     std::cout << "\n=== Example 18: epoll Transport ===" << std::endl;
+     
+     serialflex::EpollTransport transport(serialflex::PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE, 4 * 1024 * 1024);
+     
+     //! A socketpair and a pseudo-terminal, each with both ends in the same event loop
+     int sockets[2];
+     int master = -1;
+     int slave = -1;
+     if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0 ||
+         openpty(&master, &slave, nullptr, nullptr, nullptr) != 0) {
+         std::cout << "Could not create socketpair/pty" << std::endl;
+         return;
+     }
+     serialflex::configureRawTty(master);
+     serialflex::configureRawTty(slave);
+     
+     //! A pipe is one-directional: its write end only sends, its read end only receives
+     int pipeFds[2];
+     if (pipe2(pipeFds, O_CLOEXEC) != 0) {
+         std::cout << "Could not create pipe" << std::endl;
+         return;
+     }
+     
+     size_t host = transport.addLink(sockets[0]);
+     size_t device = transport.addLink(sockets[1]);
+     size_t ttyHost = transport.addLink(master);
+     size_t ttyDevice = transport.addLink(slave);
+     size_t pipeOut = transport.addLink(pipeFds[1]);
+     size_t pipeIn = transport.addLink(pipeFds[0]);
+     
+     //! Commands go host -> device over the socket and the pty; the device answers each
+     //! with SensorData. Bulk readings stream through the pipe, far beyond its 64 KB buffer.
+     constexpr uint32_t requestCount = 1000;
+     constexpr uint32_t bulkCount = 50000;
+     Command request{Command::CommandType::GET, 0x0042, "sensor", {}, {}};
+     for (uint32_t i = 0; i < requestCount; i++) {
+         transport.sendMessage(host, 0x02, request);
+         transport.sendMessage(ttyHost, 0x02, request);
+     }
+     size_t maxQueued = 0;
+     for (uint32_t seq = 0; seq < bulkCount; seq++) {
+         transport.sendMessage(pipeOut, 0x01, SensorData{21.0f, 40.0f, seq, "BULK", {1, 2, 3}});
+         maxQueued = std::max(maxQueued, transport.queuedBytes(pipeOut));
+     }
+     
+     uint32_t responses = 0;
+     uint32_t bulkReceived = 0;
+     uint32_t errors = 0;
+     auto start = std::chrono::high_resolution_clock::now();
+     while (responses < 2 * requestCount || bulkReceived < bulkCount) {
+         transport.poll(1000, [&](size_t link, const serialflex::DeframedPacket& packet) {
+             if (!packet.valid()) {
+                 errors++;
+             } else if (link == device || link == ttyDevice) {
+                 SensorData reply{22.5f, 45.0f, 0, "DEV", {7}};
+                 transport.sendMessage(link, 0x01, reply);
+             } else if (link == pipeIn) {
+                 bulkReceived++;
+             } else {
+                 responses++;
+             }
+         });
+     }
+     auto end = std::chrono::high_resolution_clock::now();
+     
+     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+     std::cout << "Request/response over socketpair and pty: " << responses << " replies" << std::endl;
+     std::cout << "Bulk frames through the pipe: " << bulkReceived << " (up to " << maxQueued / 1024
+               << " KB queued behind partial writes)" << std::endl;
+     std::cout << "Frame errors: " << errors << ", elapsed: " << duration << " µs" << std::endl;
+ }
+ 
+ //! Streams frames from one end of each link to the other and returns frames per second.
+ //! send() refusing more bytes is backpressure: poll until the transport drains.
+ template<typename Transport>
+ double streamFrames(Transport& transport, const std::vector<std::pair<size_t, size_t>>& links, uint32_t framesPerLink) {
+     std::vector<uint32_t> sent(links.size(), 0);
+     
+     SensorData reading{21.0f, 40.0f, 0, "BENCH", {1, 2, 3}};
+     size_t total = 0;
+     auto start = std::chrono::high_resolution_clock::now();
+     while (total < links.size() * framesPerLink) {
+         for (size_t i = 0; i < links.size(); i++) {
+             while (sent[i] < framesPerLink) {
+                 reading.timestamp = sent[i];
+                 if (!transport.sendMessage(links[i].first, 0x01, reading)) {
+                     break;
+                 }
+                 sent[i]++;
+             }
+         }
+         transport.poll(1000, [&](size_t, const serialflex::DeframedPacket& packet) {
+             if (packet.valid()) {
+                 total++;
+             }
+         });
+     }
+     auto end = std::chrono::high_resolution_clock::now();
+     return total / std::chrono::duration<double>(end - start).count();
+ }
+ 
+ //! Opens linkCount socketpairs or pipes and registers both ends as (sender, receiver) links
+ template<typename Transport>
+ std::vector<std::pair<size_t, size_t>> openLinks(Transport& transport, size_t linkCount, bool usePipes) {
+     std::vector<std::pair<size_t, size_t>> links;
+     for (size_t i = 0; i < linkCount; i++) {
+         int fds[2];
+         int result = usePipes ? pipe2(fds, O_CLOEXEC) : socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds);
+         if (result != 0) {
+             break;
+         }
+         if (usePipes) {
+             std::swap(fds[0], fds[1]); //! pipe2 returns the read end first
+         }
+         size_t sender = transport.addLink(fds[0]);
+         size_t receiver = transport.addLink(fds[1]);
+         links.emplace_back(sender, receiver);
+     }
+     return links;
+ }
+ 
+ void example19_uringTransport() {
+     std::cout << "\n=== Example 19: io_uring Transport ===" << std::endl;
+     
+     constexpr size_t linkCount = 16;
+     constexpr uint32_t framesPerLink = 20000;
+     
+     for (bool usePipes : {false, true}) {
+         double epollRate = 0;
+         double uringRate = 0;
+         {
+             serialflex::EpollTransport transport(serialflex::PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE, 64 * 1024);
+             epollRate = streamFrames(transport, openLinks(transport, linkCount, usePipes), framesPerLink);
+         }
+         try {
+             serialflex::UringTransport transport(2 * linkCount);
+             uringRate = streamFrames(transport, openLinks(transport, linkCount, usePipes), framesPerLink);
+         } catch (const std::system_error& e) {
+             std::cout << "io_uring unavailable: " << e.what() << std::endl;
+             return;
+         }
+         
+         std::cout << linkCount << (usePipes ? " pipes" : " socketpairs") << ", " << framesPerLink
+                   << " frames each:" << std::endl;
+         std::cout << "  epoll:    " << std::fixed << std::setprecision(0) << epollRate << " frames/s" << std::endl;
+         std::cout << "  io_uring: " << uringRate << " frames/s (" << std::setprecision(2)
+                   << uringRate / epollRate << "x)" << std::endl;
+     }
+ }
+ #endif
+ 
+ #if defined(__linux__) && defined(__cpp_impl_coroutine)
+ void example20_coroutines() {
+     std::cout << "\n=== Example 20: Coroutines ===" << std::endl;
+     
+     using Registry = serialflex::MessageRegistry<
+         serialflex::Message<0x01, SensorData>,
+         serialflex::Message<0x02, Command>
+     >;
+     
+     int sockets[2];
+     if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0) {
+         std::cout << "Could not create socketpair" << std::endl;
+         return;
+     }
+     serialflex::EpollTransport transport;
+     size_t hostId = transport.addLink(sockets[0]);
+     size_t deviceId = transport.addLink(sockets[1]);
+     auto host = serialflex::makeAsyncLink<Registry>([&](serialflex::ByteSpan frame) { return transport.send(hostId, frame); });
+     auto device = serialflex::makeAsyncLink<Registry>([&](serialflex::ByteSpan frame) { return transport.send(deviceId, frame); });
+     
+     //! Device: answer every command with a reading, written as straight-line code
+     auto serve = [&]() -> serialflex::Task<> {
+         for (uint32_t served = 0;; served++) {
+             Command command = co_await device.receive<Command>();
+             SensorData reading{22.5f, 45.0f, served, command.targetName, {command.deviceId}};
+             co_await device.send(reading);
+         }
+     };
+     
+     //! Host: many concurrent request/response sessions on one thread, no callbacks
+     auto session = [&](uint16_t deviceNumber, uint32_t requests) -> serialflex::Task<uint32_t> {
+         uint32_t answered = 0;
+         for (uint32_t i = 0; i < requests; i++) {
+             Command request{Command::CommandType::GET, deviceNumber, "sensor", {}, {}};
+             co_await host.send(request);
+             SensorData reply = co_await host.receive<SensorData>();
+             answered += reply.sensorId == "sensor" ? 1 : 0;
+         }
+         co_return answered;
+     };
+     
+     constexpr uint16_t sessionCount = 100;
+     constexpr uint32_t requestsPerSession = 100;
+     serialflex::Task<> server = serve();
+     std::vector<serialflex::Task<uint32_t>> sessions;
+     
+     auto start = std::chrono::high_resolution_clock::now();
+     for (uint16_t i = 0; i < sessionCount; i++) {
+         sessions.push_back(session(i, requestsPerSession));
+     }
+     auto allDone = [&] {
+         return std::all_of(sessions.begin(), sessions.end(), [](const auto& task) { return task.done(); });
+     };
+     while (!allDone()) {
+         //! Frames resume the waiting coroutines inline, inside poll()
+         transport.poll(1000, [&](size_t link, const serialflex::DeframedPacket& packet) {
+             if (link == hostId) {
+                 host.deliver(packet);
+             } else {
+                 device.deliver(packet);
+             }
+         });
+         host.writable();
+         device.writable();
+     }
+     auto end = std::chrono::high_resolution_clock::now();
+     
+     uint32_t answered = 0;
+     for (auto& task : sessions) {
+         answered += task.result();
+     }
+     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+     std::cout << sessionCount << " sessions x " << requestsPerSession << " requests: " << answered
+               << " answered in " << duration << " µs" << std::endl;
+ }
+ #endif
+ 
+ #if defined(__linux__)
+ //! Streams frameCount frames of payload through transport link out, then returns MB/s
+ template<typename SendFrame>
+ double timeTransmit(serialflex::EpollTransport& transport, size_t out, size_t frameCount, size_t frameBytes,
+                     SendFrame&& sendFrame) {
+     auto start = std::chrono::high_resolution_clock::now();
+     for (size_t i = 0; i < frameCount; i++) {
+         while (!sendFrame()) {
+             transport.poll(-1, [](size_t, const serialflex::DeframedPacket&) {});
+         }
+     }
+     while (transport.queuedBytes(out) > 0) {
+         transport.poll(-1, [](size_t, const serialflex::DeframedPacket&) {});
+     }
+     auto end = std::chrono::high_resolution_clock::now();
+     return frameCount * frameBytes / std::chrono::duration<double>(end - start).count() / (1024.0 * 1024.0);
+ }
+ 
+ void example21_scatterGather() {
+     std::cout << "\n=== Example 21: Scatter-Gather Transmit ===" << std::endl;
+     
+     //! A reader thread drains the pipe; the transport only writes to it
+     int pipeFds[2];
+     if (pipe2(pipeFds, O_CLOEXEC) != 0) {
+         std::cout << "Could not create pipe" << std::endl;
+         return;
+     }
+     std::thread drain([fd = pipeFds[0]] {
+         std::vector<uint8_t> sink(1024 * 1024);
+         while (::read(fd, sink.data(), sink.size()) > 0) {}
+         ::close(fd);
+     });
+     
+     serialflex::EpollTransport transport(serialflex::PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE, 1024 * 1024);
+     size_t out = transport.addLink(pipeFds[1]);
+     
+     //! Bulk payload without bytes that need stuffing, as sensor dumps usually are
+     std::vector<uint8_t> payload(60000);
+     for (size_t i = 0; i < payload.size(); i++) {
+         payload[i] = static_cast<uint8_t>(i % 0x70);
+     }
+     constexpr size_t frameCount = 20000;
+     
+     std::vector<uint8_t> frame;
+     double copyRate = timeTransmit(transport, out, frameCount, payload.size(), [&] {
+         serialflex::PacketFramer::framePacketInto(frame, 0x05, serialflex::ByteSpan(payload));
+         return transport.send(out, serialflex::ByteSpan(frame));
+     });
+     double scatterRate = timeTransmit(transport, out, frameCount, payload.size(), [&] {
+         return transport.sendPayload(out, 0x05, serialflex::ByteSpan(payload));
+     });
+     
+     transport.removeLink(out); //! Closes the write end, ending the reader
+     drain.join();
+     
+     std::cout << frameCount << " frames of " << payload.size() / 1000 << " KB through a pipe:" << std::endl;
+     std::cout << "  framePacketInto + send: " << std::fixed << std::setprecision(0) << copyRate << " MB/s" << std::endl;
+     std::cout << "  sendPayload (writev):   " << scatterRate << " MB/s (" << std::setprecision(2)
+               << scatterRate / copyRate << "x)" << std::endl;
+ }
+ #endif
+ 
+ #if defined(__linux__)
+ void example22_sharedMemory() {
+     std::cout << "\n=== Example 22: Shared-Memory IPC ===" << std::endl;
+     
+     //! One ring per direction, mapped before fork() so the child shares them
+     serialflex::ShmRing requests = serialflex::ShmRing::anonymous(64 * 1024);
+     serialflex::ShmRing replies = serialflex::ShmRing::anonymous(64 * 1024);
+     int sockets[2];
+     if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0) {
+         std::cout << "Could not create socketpair" << std::endl;
+         return;
+     }
+     constexpr uint32_t roundTrips = 20000;
+     constexpr uint8_t STOP = 0x00;
+     
+     std::cout.flush();
+     pid_t child = fork();
+     if (child < 0) {
+         std::cout << "fork failed" << std::endl;
+         return;
+     }
+     if (child == 0) {
+         //! Device process: decode each command straight out of shared memory and answer it
+         bool running = true;
+         while (running) {
+             requests.read([&](const serialflex::ShmMessage& message) {
+                 if (message.messageId == STOP) {
+                     running = false;
+                     return;
+                 }
+                 uint32_t sequence = serialflex::deserialize<uint32_t>(message.payload);
+                 replies.writeMessage(0x01, sequence);
+             });
+         }
+         
+         //! Same exchange over the socketpair for comparison
+         uint32_t sequence = 0;
+         for (uint32_t i = 0; i < roundTrips; i++) {
+             if (::read(sockets[1], &sequence, sizeof(sequence)) != sizeof(sequence) ||
+                 ::write(sockets[1], &sequence, sizeof(sequence)) != sizeof(sequence)) {
+                 break;
+             }
+         }
+         _exit(0);
+     }
+     
+     uint32_t mismatches = 0;
+     auto start = std::chrono::high_resolution_clock::now();
+     for (uint32_t i = 0; i < roundTrips; i++) {
+         requests.writeMessage(0x02, i);
+         replies.read([&](const serialflex::ShmMessage& message) {
+             mismatches += serialflex::deserialize<uint32_t>(message.payload) != i ? 1 : 0;
+         });
+     }
+     auto end = std::chrono::high_resolution_clock::now();
+     requests.write(STOP, serialflex::ByteSpan());
+     double shmLatency = std::chrono::duration<double, std::micro>(end - start).count() / roundTrips;
+     
+     start = std::chrono::high_resolution_clock::now();
+     for (uint32_t i = 0; i < roundTrips; i++) {
+         uint32_t echo = 0;
+         if (::write(sockets[0], &i, sizeof(i)) != sizeof(i) || ::read(sockets[0], &echo, sizeof(echo)) != sizeof(echo)) {
+             break;
+         }
+     }
+     end = std::chrono::high_resolution_clock::now();
+     double socketLatency = std::chrono::duration<double, std::micro>(end - start).count() / roundTrips;
+     
+     waitpid(child, nullptr, 0);
+     ::close(sockets[0]);
+     ::close(sockets[1]);
+     
+     std::cout << roundTrips << " round trips between processes (" << std::thread::hardware_concurrency()
+               << " CPUs), " << mismatches << " mismatches:" << std::endl;
+     std::cout << "  shared-memory ring: " << std::fixed << std::setprecision(2) << shmLatency << " µs" << std::endl;
+     std::cout << "  UNIX socketpair:    " << socketLatency << " µs" << std::endl;
+ }
+ #endif
+
+ struct ArqRun {
+     double seconds;
+     double frameLoss;
+     uint64_t retransmitted;
+     uint64_t fastRetransmitted;
+     bool inOrder;
+ };
+ 
+ ArqRun simulateArq(serialflex::ArqConfig config, double bitErrorRate, uint32_t messageCount) {
+     //! 1 Mbit/s each way, 20 ms one-way latency
+     serialflex::LinkModel model;
+     model.baudRate = 1000000;
+     model.latency = std::chrono::milliseconds(20);
+     model.bitErrorRate = bitErrorRate;
+     serialflex::LinkSimulator link(model);
+     
+     using Sink = std::function<void(serialflex::ByteSpan)>;
+     serialflex::ArqLink<Sink> sender([&](serialflex::ByteSpan frame) { link.write(serialflex::LinkSide::A, frame); }, config);
+     serialflex::ArqLink<Sink> receiver([&](serialflex::ByteSpan frame) { link.write(serialflex::LinkSide::B, frame); }, config);
+     
+     std::vector<uint8_t> payload(200);
+     uint32_t sent = 0;
+     uint32_t delivered = 0;
+     uint64_t framesReceived = 0;
+     bool inOrder = true;
+     auto onMessage = [&](uint8_t, serialflex::ByteSpan body) {
+         inOrder = inOrder && serialflex::deserialize<uint32_t>(body.subspan(0, 4)) == delivered;
+         delivered++;
+     };
+     
+     while (delivered < messageCount) {
+         while (sent < messageCount && sender.canSend()) {
+             std::memcpy(payload.data(), &sent, sizeof(sent));
+             sender.send(0x01, serialflex::ByteSpan(payload), link.now());
+             sent++;
+         }
+         
+         //! Run the link up to the next arrival or protocol timer, whichever is first
+         link.step(std::min(sender.nextDeadline(), receiver.nextDeadline()),
+                   [&](serialflex::LinkSide side, const serialflex::DeframedPacket& packet) {
+             if (side == serialflex::LinkSide::B) {
+                 framesReceived += receiver.receive(packet, link.now(), onMessage) ? 1 : 0;
+             } else {
+                 sender.receive(packet, link.now(), onMessage);
+             }
+         });
+         sender.tick(link.now());
+         receiver.tick(link.now());
+     }
+     
+     uint64_t framesSent = sender.stats().sent + sender.stats().retransmitted + sender.stats().fastRetransmitted;
+     return {std::chrono::duration<double>(link.now().time_since_epoch()).count(),
+             1.0 - static_cast<double>(framesReceived) / framesSent, sender.stats().retransmitted,
+             sender.stats().fastRetransmitted, inOrder};
+ }
+ 
+ void example23_reliableDelivery() {
+     std::cout << "\n=== Example 23: Reliable Delivery (Selective-Repeat ARQ) ===" << std::endl;
+     
+     constexpr uint32_t messageCount = 2000;
+     serialflex::ArqConfig stopAndWait;
+     stopAndWait.window = 1;
+     stopAndWait.ackEvery = 1;
+     serialflex::ArqConfig selectiveRepeat;
+     selectiveRepeat.window = 128;
+     
+     std::cout << messageCount << " messages of 200 bytes over a simulated 1 Mbit/s link with 20 ms latency:" << std::endl;
+     for (double bitErrorRate : {0.0, 3e-5, 1.5e-4}) {
+         ArqRun waitRun = simulateArq(stopAndWait, bitErrorRate, messageCount);
+         ArqRun repeatRun = simulateArq(selectiveRepeat, bitErrorRate, messageCount);
+         std::cout << "  " << std::setfill(' ') << std::setw(2) << std::fixed << std::setprecision(0) << repeatRun.frameLoss * 100
+                   << "% frame loss: stop-and-wait " << std::setprecision(1)
+                   << messageCount * 200 * 8 / waitRun.seconds / 1000 << " kbit/s, selective repeat "
+                   << messageCount * 200 * 8 / repeatRun.seconds / 1000 << " kbit/s (" << repeatRun.retransmitted
+                   << " timeouts, " << repeatRun.fastRetransmitted << " fast resends, "
+                   << (waitRun.inOrder && repeatRun.inOrder ? "in order" : "OUT OF ORDER") << ")" << std::endl;
+     }
+ }
+ 
+ //! Push frames through a link that flips bits at the given rate and count the survivors
+ template<typename Frame, typename Accept>
+ double deliveredFraction(double bitErrorRate, size_t frameCount, Frame&& frame, Accept&& accept) {
+     serialflex::LinkModel model;
+     model.baudRate = 1000000;
+     model.bitErrorRate = bitErrorRate;
+     model.seed = 7;
+     serialflex::LinkSimulator link(model);
+     link.receiver(serialflex::LinkSide::B).setKeepCorruptPayloads(true);
+     
+     size_t delivered = 0;
+     for (size_t i = 0; i < frameCount; i++) {
+         std::vector<uint8_t> bytes = frame(i);
+         link.write(serialflex::LinkSide::A, serialflex::ByteSpan(bytes));
+     }
+     link.drain([&](serialflex::LinkSide, serialflex::DeframedPacket& packet) {
+         delivered += accept(packet) ? 1 : 0;
+     });
+     return static_cast<double>(delivered) / frameCount;
+ }
+ 
+ //! Bytes whose corruption changes the frame structure, which FEC cannot repair
+ bool isFramingByte(uint8_t byte) {
+     return byte == serialflex::PacketFramer::START_BYTE || byte == serialflex::PacketFramer::END_BYTE ||
+            byte == serialflex::PacketFramer::ESCAPE_BYTE;
+ }
+ 
+ void example24_forwardErrorCorrection() {
+     std::cout << "\n=== Example 24: Forward Error Correction ===" << std::endl;
+     
+     serialflex::FecCodec codec(16); //! Repairs up to 8 bytes per 255-byte codeword
+     std::vector<uint8_t> payload(200);
+     for (size_t i = 0; i < payload.size(); i++) {
+         payload[i] = static_cast<uint8_t>(i * 37);
+     }
+     constexpr size_t frameCount = 5000;
+     
+     std::cout << "Frames of " << payload.size() << " bytes, " << codec.encodedSize(payload.size()) - payload.size()
+               << " parity bytes each, through a channel with random bit errors:" << std::endl;
+     for (double bitErrorRate : {1e-4, 1e-3, 3e-3}) {
+         double plain = deliveredFraction(bitErrorRate, frameCount, [&](size_t) {
+             return serialflex::PacketFramer::framePacket(0x01, payload);
+         }, [](const serialflex::DeframedPacket& packet) {
+             return packet.valid();
+         });
+         
+         //! decode() does not re-verify a repair, so check what it hands over
+         size_t miscorrected = 0;
+         double protectedRate = deliveredFraction(bitErrorRate, frameCount, [&](size_t) {
+             return codec.framePacket(0x01, serialflex::ByteSpan(payload));
+         }, [&](serialflex::DeframedPacket& packet) {
+             if (!codec.decode(packet).valid()) {
+                 return false;
+             }
+             bool intact = packet.payload.size() == payload.size() &&
+                           std::equal(payload.begin(), payload.end(), packet.payload.begin());
+             miscorrected += intact ? 0 : 1;
+             return intact;
+         });
+         std::cout << "  BER " << std::scientific << std::setprecision(0) << bitErrorRate << std::fixed
+                   << std::setprecision(1) << ": CRC only " << plain * 100 << "% delivered, with FEC "
+                   << protectedRate * 100 << "% (" << miscorrected << " miscorrected)" << std::endl;
+     }
+     
+     //! A single captured frame: deframePacket keeps the damaged payload on request
+     std::vector<uint8_t> frame = codec.framePacket(0x01, serialflex::ByteSpan(payload));
+     size_t flipped = 0;
+     for (size_t i = 4; i + 3 < frame.size() && flipped < 6; i += 29) {
+         uint8_t damaged = frame[i] ^ 0x04;
+         if (!isFramingByte(frame[i]) && !isFramingByte(damaged)) {
+             frame[i] = damaged;
+             flipped++;
+         }
+     }
+     serialflex::DeframedPacket captured = serialflex::PacketFramer::deframePacket(frame, true);
+     serialflex::FrameStatus wireStatus = captured.status;
+     serialflex::FecResult repaired = codec.decode(captured);
+     std::cout << "One-shot deframe of a frame with " << flipped << " corrupted bytes: "
+               << (wireStatus == serialflex::FrameStatus::CrcMismatch ? "CRC mismatch" : "CRC ok") << ", "
+               << (repaired.status == serialflex::FecStatus::Corrected ? "corrected " : "not corrected ")
+               << repaired.correctedBytes << " bytes, payload "
+               << (std::equal(payload.begin(), payload.end(), captured.payload.begin()) ? "intact" : "damaged")
+               << std::endl;
+     
+     //! Encoding cost, to weigh against a retransmission round trip
+     std::vector<uint8_t> bulk(1000, 0x55);
+     constexpr size_t rounds = 2000;
+     auto start = std::chrono::high_resolution_clock::now();
+     for (size_t i = 0; i < rounds; i++) {
+         bulk[i % bulk.size()] = static_cast<uint8_t>(i);
+         codec.framePacketInto(frame, 0x01, serialflex::ByteSpan(bulk));
+     }
+     auto end = std::chrono::high_resolution_clock::now();
+     std::cout << "Encoding: " << std::setprecision(0)
+               << rounds * bulk.size() / std::chrono::duration<double>(end - start).count() / (1024.0 * 1024.0)
+               << " MB/s" << std::endl;
+ }
+
+ //! Telemetry protocols compared in Example 25. Each one sends a payload from A to B
+ //! and hands B every intact payload it recovers, possibly more than once.
+ struct PlainTelemetry {
+     serialflex::LinkSimulator& link;
+     
+     void transmit(serialflex::ByteSpan payload) {
+         link.write(serialflex::LinkSide::A, serialflex::ByteSpan(serialflex::PacketFramer::framePacket(
+             0x01, std::vector<uint8_t>(payload.begin(), payload.end()))));
+     }
+     template<typename Deliver>
+     void receive(serialflex::LinkSide side, serialflex::DeframedPacket& packet, Deliver&& deliver) {
+         if (side == serialflex::LinkSide::B && packet.valid()) {
+             deliver(serialflex::ByteSpan(packet.payload));
+         }
+     }
+     serialflex::LinkSimulator::TimePoint deadline() const {
+         return serialflex::LinkSimulator::TimePoint::max();
+     }
+     void tick() {}
+ };
+ 
+ struct FecTelemetry : PlainTelemetry {
+     serialflex::FecCodec codec{16};
+     
+     void transmit(serialflex::ByteSpan payload) {
+         link.write(serialflex::LinkSide::A, serialflex::ByteSpan(codec.framePacket(0x01, payload)));
+     }
+     template<typename Deliver>
+     void receive(serialflex::LinkSide side, serialflex::DeframedPacket& packet, Deliver&& deliver) {
+         if (side == serialflex::LinkSide::B && codec.decode(packet).valid()) {
+             deliver(serialflex::ByteSpan(packet.payload));
+         }
+     }
+ };
+ 
+ struct ArqTelemetry {
+     using Sink = std::function<void(serialflex::ByteSpan)>;
+     
+     serialflex::LinkSimulator& link;
+     serialflex::ArqLink<Sink> sender{[this](serialflex::ByteSpan frame) { link.write(serialflex::LinkSide::A, frame); }};
+     serialflex::ArqLink<Sink> receiver{[this](serialflex::ByteSpan frame) { link.write(serialflex::LinkSide::B, frame); }};
+     std::deque<std::vector<uint8_t>> backlog{}; //! Waiting for room in the window
+     
+     void transmit(serialflex::ByteSpan payload) {
+         backlog.emplace_back(payload.begin(), payload.end());
+         flush();
+     }
+     template<typename Deliver>
+     void receive(serialflex::LinkSide side, serialflex::DeframedPacket& packet, Deliver&& deliver) {
+         auto onMessage = [&](uint8_t, serialflex::ByteSpan payload) { deliver(payload); };
+         if (side == serialflex::LinkSide::B) {
+             receiver.receive(packet, link.now(), onMessage);
+         } else {
+             sender.receive(packet, link.now(), onMessage);
+             flush();
+         }
+     }
+     serialflex::LinkSimulator::TimePoint deadline() const {
+         return std::min(sender.nextDeadline(), receiver.nextDeadline());
+     }
+     void tick() {
+         sender.tick(link.now());
+         receiver.tick(link.now());
+     }
+     void flush() {
+         while (!backlog.empty() && sender.send(0x01, serialflex::ByteSpan(backlog.front()), link.now())) {
+             backlog.pop_front();
+         }
+     }
+ };
+ 
+ //! Offer one 100-byte message every interval and measure what arrives within the run
+ template<typename Protocol>
+ serialflex::LinkReport runTelemetry(serialflex::LinkSimulator& link, Protocol& protocol, uint32_t count,
+                                     std::chrono::milliseconds interval) {
+     using TimePoint = serialflex::LinkSimulator::TimePoint;
+     serialflex::LinkMeter meter;
+     std::vector<TimePoint> sentAt(count);
+     std::vector<bool> seen(count, false);
+     std::vector<uint8_t> payload(100, 0x42);
+     TimePoint lastDelivery{};
+     TimePoint end = TimePoint() + interval * count + std::chrono::seconds(10);
+     
+     auto deliver = [&](serialflex::ByteSpan body) {
+         uint32_t sequence = serialflex::deserialize<uint32_t>(body.subspan(0, 4));
+         if (sequence < count && !seen[sequence]) {
+             seen[sequence] = true;
+             meter.delivered(body.size(), sentAt[sequence], link.now());
+             lastDelivery = link.now();
+         }
+     };
+     
+     uint32_t sent = 0;
+     while (link.now() < end) {
+         TimePoint nextSend = sent < count ? TimePoint() + interval * sent : TimePoint::max();
+         if (link.now() >= nextSend) {
+             std::memcpy(payload.data(), &sent, sizeof(sent));
+             sentAt[sent++] = link.now();
+             meter.sent();
+             protocol.transmit(serialflex::ByteSpan(payload));
+             continue;
+         }
+         link.step(std::min({nextSend, protocol.deadline(), end}), [&](serialflex::LinkSide side, serialflex::DeframedPacket& packet) {
+             protocol.receive(side, packet, deliver);
+         });
+         protocol.tick();
+     }
+     return meter.report(lastDelivery.time_since_epoch());
+ }
+ 
+ void example25_linkSimulator() {
+     std::cout << "\n=== Example 25: Link Simulator ===" << std::endl;
+     
+     //! A 115200 baud radio with 40 ms latency, background bit errors, error bursts,
+     //! occasional lost bytes and duplicated writes
+     serialflex::LinkModel radio;
+     radio.baudRate = 115200;
+     radio.latency = std::chrono::milliseconds(40);
+     radio.bitErrorRate = 2e-5;
+     radio.burstRate = 2e-4;
+     radio.burstLength = 6;
+     radio.byteDropRate = 1e-5;
+     radio.duplicateRate = 0.01;
+     radio.seed = 42;
+     
+     constexpr uint32_t count = 2000;
+     const auto interval = std::chrono::milliseconds(20);
+     auto print = [](const char* name, const serialflex::LinkReport& report) {
+         auto ms = [](std::chrono::nanoseconds value) { return std::chrono::duration<double, std::milli>(value).count(); };
+         std::cout << "  " << std::setfill(' ') << std::left << std::setw(4) << name << std::right << std::fixed << std::setprecision(1)
+                   << " loss " << std::setw(5) << report.lossRate * 100 << "%, goodput " << std::setw(4)
+                   << report.goodputBitsPerSecond / 1000 << " kbit/s, latency p50 " << std::setw(5)
+                   << ms(report.latencyP50) << " ms, p99 " << std::setw(6) << ms(report.latencyP99)
+                   << " ms, max " << std::setw(6) << ms(report.latencyMax) << " ms" << std::endl;
+     };
+     
+     std::cout << count << " telemetry messages of 100 bytes every " << interval.count()
+               << " ms over a noisy 115200 baud radio (seed " << radio.seed << "):" << std::endl;
+     {
+         serialflex::LinkSimulator link(radio);
+         PlainTelemetry protocol{link};
+         print("CRC", runTelemetry(link, protocol, count, interval));
+     }
+     {
+         serialflex::LinkSimulator link(radio);
+         link.receiver(serialflex::LinkSide::B).setKeepCorruptPayloads(true);
+         FecTelemetry protocol{{link}};
+         print("FEC", runTelemetry(link, protocol, count, interval));
+     }
+     {
+         serialflex::LinkSimulator link(radio);
+         ArqTelemetry protocol{link};
+         print("ARQ", runTelemetry(link, protocol, count, interval));
+     }
+ }
+ 
+ struct FlowRun {
+     uint32_t processed;
+     uint64_t dropped;
+     double seconds;
+     uint64_t probes;
+ };
+ 
+ //! A host streams messages to an MCU that holds `capacity` bytes and works through
+ //! one message every `serviceTime`; the link loses the odd frame to bit errors
+ FlowRun simulateMcu(bool flowControl, uint32_t messageCount, size_t capacity, std::chrono::milliseconds serviceTime) {
+     using TimePoint = serialflex::LinkSimulator::TimePoint;
+     serialflex::LinkModel model;
+     model.baudRate = 1000000;
+     model.latency = std::chrono::milliseconds(5);
+     model.bitErrorRate = 2e-6;
+     serialflex::LinkSimulator link(model);
+     
+     using Sink = std::function<void(serialflex::ByteSpan)>;
+     serialflex::CreditConfig config;
+     config.probeInterval = std::chrono::milliseconds(20);
+     serialflex::CreditLink<Sink> host([&](serialflex::ByteSpan frame) { link.write(serialflex::LinkSide::A, frame); },
+                                       64 * 1024, config);
+     serialflex::CreditLink<Sink> mcu([&](serialflex::ByteSpan frame) { link.write(serialflex::LinkSide::B, frame); },
+                                      capacity, config);
+     mcu.advertise();
+     
+     //! The MCU's receive buffer: payload sizes waiting to be processed
+     std::deque<size_t> buffer;
+     size_t buffered = 0;
+     uint64_t dropped = 0;
+     uint32_t processed = 0;
+     TimePoint nextService = TimePoint::max();
+     
+     std::vector<uint8_t> payload(100, 0x33);
+     for (uint32_t i = 0; i < messageCount; i++) {
+         if (flowControl) {
+             host.send(0x01, serialflex::ByteSpan(payload), link.now());
+         } else {
+             link.write(serialflex::LinkSide::A, serialflex::ByteSpan(serialflex::PacketFramer::framePacket(0x01, payload)));
+         }
+     }
+     
+     auto store = [&](uint8_t, serialflex::ByteSpan body) {
+         if (buffered + body.size() + config.frameCost > capacity) {
+             dropped++; //! Overflow: nowhere to put it
+             return;
+         }
+         buffer.push_back(body.size());
+         buffered += body.size() + config.frameCost;
+         nextService = std::min(nextService, link.now() + serviceTime);
+     };
+     
+     TimePoint end = TimePoint() + std::chrono::seconds(60);
+     while (link.now() < end && (host.blocked() || link.channel(serialflex::LinkSide::A).nextArrival() != TimePoint::max() || !buffer.empty())) {
+         link.step(std::min({nextService, host.nextDeadline(), end}), [&](serialflex::LinkSide side, serialflex::DeframedPacket& packet) {
+             if (side == serialflex::LinkSide::B) {
+                 if (flowControl) {
+                     mcu.receive(packet, link.now(), store);
+                 } else if (packet.valid()) {
+                     store(packet.messageId, serialflex::ByteSpan(packet.payload));
+                 }
+             } else {
+                 host.receive(packet, link.now(), [](uint8_t, serialflex::ByteSpan) {});
+             }
+         });
+         if (link.now() >= nextService && !buffer.empty()) {
+             size_t size = buffer.front();
+             buffer.pop_front();
+             buffered -= size + config.frameCost;
+             processed++;
+             mcu.release(size);
+             nextService = buffer.empty() ? TimePoint::max() : link.now() + serviceTime;
+         }
+         host.tick(link.now());
+     }
+     
+     return {processed, dropped + mcu.stats().overruns, std::chrono::duration<double>(link.now().time_since_epoch()).count(),
+             host.stats().probesSent};
+ }
+ 
+ void example26_flowControl() {
+     std::cout << "\n=== Example 26: Credit-Based Flow Control ===" << std::endl;
+     
+     constexpr uint32_t messageCount = 500;
+     const auto serviceTime = std::chrono::milliseconds(2);
+     std::cout << messageCount << " messages of 100 bytes from a host to an MCU with a 2 KB buffer that handles one every "
+               << serviceTime.count() << " ms:" << std::endl;
+     for (bool flowControl : {false, true}) {
+         FlowRun run = simulateMcu(flowControl, messageCount, 2048, serviceTime);
+         std::cout << "  " << (flowControl ? "credits:   " : "no credits:") << " " << run.processed << " processed, "
+                   << run.dropped << " dropped on overflow, done after " << std::fixed << std::setprecision(2)
+                   << run.seconds << " s";
+         if (flowControl) {
+             std::cout << " (" << run.probes << " probes)";
+         }
+         std::cout << std::endl;
+     }
+ }
+ 
+ //! Three kinds of traffic for Example 27: commands, telemetry and a bulk log stream
+ //! offered at about 120% of what the line carries
+ struct TrafficRun {
+     uint64_t writes;
+     serialflex::LinkReport reports[3];
+     std::chrono::nanoseconds lastDelivery;
+ };
+ 
+ TrafficRun simulateTraffic(bool scheduled) {
+     using TimePoint = serialflex::LinkSimulator::TimePoint;
+     using Duration = std::chrono::microseconds;
+     serialflex::LinkModel model;
+     model.baudRate = 115200;
+     serialflex::LinkSimulator link(model);
+     
+     const Duration periods[3] = {std::chrono::milliseconds(50), std::chrono::milliseconds(5), std::chrono::milliseconds(25)};
+     const size_t sizes[3] = {8, 20, 200};
+     const TimePoint end = TimePoint() + std::chrono::seconds(5);
+     
+     auto writer = [&](serialflex::ByteSpan bytes) { link.write(serialflex::LinkSide::A, bytes); };
+     std::vector<serialflex::TrafficClass> classes(3);
+     classes[0].latencyBudget = Duration(0);                            //! Commands: urgent
+     classes[1].weight = 4;
+     classes[1].latencyBudget = std::chrono::milliseconds(10);          //! Telemetry
+     classes[2].latencyBudget = std::chrono::milliseconds(50);          //! Bulk log
+     classes[2].maxQueuedBytes = 4096;
+     serialflex::SchedulerConfig config;
+     config.maxBatchBytes = 256;
+     config.lineRate = model.baudRate / 10;
+     serialflex::TransmitScheduler scheduler(writer, classes, config);
+     
+     serialflex::LinkMeter meters[3];
+     std::vector<TimePoint> sentAt[3];
+     TimePoint nextMessage[3] = {};
+     uint64_t writes = 0;
+     std::vector<uint8_t> payload;
+     TimePoint lastDelivery = end;
+     
+     auto onPacket = [&](serialflex::LinkSide, serialflex::DeframedPacket& packet) {
+         if (packet.valid()) {
+             lastDelivery = link.now();
+             uint32_t sequence = serialflex::deserialize<uint32_t>(serialflex::ByteSpan(packet.payload).subspan(0, 4));
+             meters[packet.messageId].delivered(packet.payload.size(), sentAt[packet.messageId][sequence], link.now());
+         }
+     };
+     
+     while (link.now() < end) {
+         TimePoint limit = std::min({nextMessage[0], nextMessage[1], nextMessage[2], scheduler.nextDeadline(), end});
+         link.step(limit, onPacket);
+         for (uint8_t kind = 0; kind < 3; kind++) {
+             if (link.now() < nextMessage[kind]) {
+                 continue;
+             }
+             nextMessage[kind] += periods[kind];
+             uint32_t sequence = static_cast<uint32_t>(sentAt[kind].size());
+             payload.assign(sizes[kind], kind);
+             std::memcpy(payload.data(), &sequence, sizeof(sequence));
+             if (scheduled) {
+                 if (!scheduler.enqueue(kind, kind, serialflex::ByteSpan(payload), link.now())) {
+                     continue; //! Bulk queue full: the log producer skips a chunk
+                 }
+             } else {
+                 //! One write per message, straight into the driver's FIFO
+                 link.write(serialflex::LinkSide::A, serialflex::ByteSpan(serialflex::PacketFramer::framePacket(kind, payload)));
+                 writes++;
+             }
+             sentAt[kind].push_back(link.now());
+             meters[kind].sent();
+         }
+         scheduler.tick(link.now());
+     }
+     
+     //! Deliver the backlog, wherever it waits: in the scheduler's queues or in the
+     //! driver. Goodput is measured up to the last delivery, so backlog that drains
+     //! after the 5 s counts as time on the line, not as extra throughput.
+     while (scheduler.queuedBytes() > 0) {
+         link.step(scheduler.nextDeadline(), onPacket);
+         scheduler.tick(link.now());
+     }
+     link.drain(onPacket);
+     
+     TrafficRun run{scheduled ? scheduler.stats().writes : writes, {}, lastDelivery - TimePoint()};
+     for (int kind = 0; kind < 3; kind++) {
+         run.reports[kind] = meters[kind].report(lastDelivery.time_since_epoch());
+     }
+     return run;
+ }
+ 
+ void example27_transmitScheduling() {
+     std::cout << "\n=== Example 27: Priority-Aware Transmit Scheduling ===" << std::endl;
+     std::cout << "Commands (8 B every 50 ms), telemetry (20 B every 5 ms) and a bulk log (200 B every 25 ms)" << std::endl;
+     std::cout << "over a 115200 baud line for 5 s, 120% offered load:" << std::endl;
+     
+     const char* names[3] = {"command", "telemetry", "bulk"};
+     auto ms = [](std::chrono::nanoseconds value) { return std::chrono::duration<double, std::milli>(value).count(); };
+     for (bool scheduled : {false, true}) {
+         TrafficRun run = simulateTraffic(scheduled);
+         std::cout << "  " << (scheduled ? "scheduler" : "write per message") << ": " << run.writes
+                   << " writes, last delivery at " << std::fixed << std::setprecision(2)
+                   << std::chrono::duration<double>(run.lastDelivery).count() << " s" << std::endl;
+         for (int kind = 0; kind < 3; kind++) {
+             const serialflex::LinkReport& report = run.reports[kind];
+             std::cout << "    " << std::setfill(' ') << std::left << std::setw(10) << names[kind] << std::right << std::fixed
+                       << std::setprecision(1) << " p50 " << std::setw(6) << ms(report.latencyP50) << " ms, p99 "
+                       << std::setw(6) << ms(report.latencyP99) << " ms, " << std::setw(5)
+                       << report.goodputBitsPerSecond / 1000 << " kbit/s" << std::endl;
+         }
+     }
+ }
+ 
  int main() {
      std::cout << "SerialFlex Library Example" << std::endl;
      std::cout << "==========================" << std::endl;
@@ -512,6 +1986,32 @@
      example5_complexType();
      example6_performance();
      example7_crc();
+     example8_dispatch();
+     example9_fragmentation();
+     example10_preemption();
+     example11_constFrames();
+     example12_decodeAllocations();
+     example13_receivePipeline();
+     example14_frameHandoff();
+     example15_multiStream();
+     example16_parallelCapture();
+     example17_batchEncoding();
+ #if defined(__linux__)
+     example18_epollTransport();
+     example19_uringTransport();
+ #endif
+ #if defined(__linux__) && defined(__cpp_impl_coroutine)
+     example20_coroutines();
+ #endif
+ #if defined(__linux__)
+     example21_scatterGather();
+     example22_sharedMemory();
+ #endif
+     example23_reliableDelivery();
+     example24_forwardErrorCorrection();
+     example25_linkSimulator();
+     example26_flowControl();
+     example27_transmitScheduling();
      
      return 0;
  }
\ No newline at end of file
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <vector>
 #include <cstdint>
 #include <string>
@@ -8,36 +10,340 @@
 #include <array>
 #include <unordered_map>
 #include <cstring>
+#include <optional>
+#include <deque>
+#include <iterator>
+#include <initializer_list>
+#if __has_include(<bit>)
+#include <bit>
+#endif
 
 namespace serialflex {
 
+//! --------------------------------
+//! BYTE VIEWS
+//! --------------------------------
+
+//! Non-owning view over a contiguous range (C++17 stand-in for std::span)
+template<typename T>
+class Span {
+public:
+    constexpr Span() noexcept : data_(nullptr), size_(0) {}
+    constexpr Span(T* data, size_t size) noexcept : data_(data), size_(size) {}
+    
+    //! Implicit view over any contiguous container exposing data() and size()
+    template<typename Container,
+             typename = std::enable_if_t<
+                 std::is_convertible_v<decltype(std::declval<Container&>().data()), T*>>>
+    constexpr Span(Container&& container) noexcept
+        : data_(container.data()), size_(container.size()) {}
+    
+    constexpr T* data() const noexcept { return data_; }
+    constexpr size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    constexpr T* begin() const noexcept { return data_; }
+    constexpr T* end() const noexcept { return data_ + size_; }
+    constexpr T& operator[](size_t index) const noexcept { return data_[index]; }
+    
+    //! View of count elements starting at offset
+    constexpr Span subspan(size_t offset, size_t count) const noexcept {
+        return Span(data_ + offset, count);
+    }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+//! Read-only byte view used throughout the framing and decoding APIs
+using ByteSpan = Span<const uint8_t>;
+
+//! --------------------------------
+//! SMALL BUFFER
+//! --------------------------------
+
+//! Inline payload capacity used by DeframedPacket and ByteReader::readBytes
+#ifndef SERIALFLEX_INLINE_PAYLOAD_SIZE
+#define SERIALFLEX_INLINE_PAYLOAD_SIZE 64
+#endif
+
+//! Byte container with N bytes of inline storage that only spills to the heap
+//! for larger contents. Offers the subset of the std::vector interface used for
+//! payloads and converts implicitly to std::vector<uint8_t> for existing code.
+template<size_t N>
+class SmallBuffer {
+    static_assert(N > 0, "Inline capacity must be non-zero");
+
+public:
+    using value_type = uint8_t;
+    using size_type = size_t;
+    using iterator = uint8_t*;
+    using const_iterator = const uint8_t*;
+    
+    static constexpr size_t INLINE_CAPACITY = N;
+    
+    SmallBuffer() noexcept : data_(inline_), size_(0), capacity_(N) {}
+    
+    explicit SmallBuffer(size_t count, uint8_t value = 0) : SmallBuffer() {
+        resize(count, value);
+    }
+    
+    template<typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    SmallBuffer(InputIt first, InputIt last) : SmallBuffer() {
+        assign(first, last);
+    }
+    
+    SmallBuffer(std::initializer_list<uint8_t> init) : SmallBuffer() {
+        assign(init.begin(), init.end());
+    }
+    
+    SmallBuffer(const SmallBuffer& other) : SmallBuffer() {
+        assign(other.begin(), other.end());
+    }
+    
+    SmallBuffer(SmallBuffer&& other) noexcept : SmallBuffer() {
+        takeFrom(other);
+    }
+    
+    ~SmallBuffer() {
+        if (!isInline()) {
+            delete[] data_;
+        }
+    }
+    
+    SmallBuffer& operator=(const SmallBuffer& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+    
+    SmallBuffer& operator=(SmallBuffer&& other) noexcept {
+        if (this != &other) {
+            if (!isInline()) {
+                delete[] data_;
+            }
+            data_ = inline_;
+            capacity_ = N;
+            size_ = 0;
+            takeFrom(other);
+        }
+        return *this;
+    }
+    
+    template<typename InputIt>
+    void assign(InputIt first, InputIt last) {
+        clear();
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<InputIt>::iterator_category>) {
+            size_t count = static_cast<size_t>(std::distance(first, last));
+            reserve(count);
+            std::copy(first, last, data_);
+            size_ = count;
+        } else {
+            for (; first != last; ++first) {
+                push_back(*first);
+            }
+        }
+    }
+    
+    void reserve(size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+        uint8_t* heap = new uint8_t[capacity];
+        if (size_ > 0) {
+            std::memcpy(heap, data_, size_);
+        }
+        if (!isInline()) {
+            delete[] data_;
+        }
+        data_ = heap;
+        capacity_ = capacity;
+    }
+    
+    void resize(size_t count, uint8_t value = 0) {
+        if (count > capacity_) {
+            reserve(std::max(count, capacity_ * 2));
+        }
+        if (count > size_) {
+            std::memset(data_ + size_, value, count - size_);
+        }
+        size_ = count;
+    }
+    
+    void push_back(uint8_t byte) {
+        if (size_ == capacity_) {
+            reserve(capacity_ * 2);
+        }
+        data_[size_++] = byte;
+    }
+    
+    //! Keeps the current capacity, like std::vector
+    void clear() noexcept {
+        size_ = 0;
+    }
+    
+    void swap(SmallBuffer& other) noexcept {
+        SmallBuffer temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+    
+    uint8_t* data() noexcept { return data_; }
+    const uint8_t* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+    size_t capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+    
+    //! True while the contents fit the inline storage
+    bool isInline() const noexcept { return data_ == inline_; }
+    
+    iterator begin() noexcept { return data_; }
+    iterator end() noexcept { return data_ + size_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator end() const noexcept { return data_ + size_; }
+    
+    uint8_t& operator[](size_t index) noexcept { return data_[index]; }
+    const uint8_t& operator[](size_t index) const noexcept { return data_[index]; }
+    
+    operator std::vector<uint8_t>() const {
+        return std::vector<uint8_t>(begin(), end());
+    }
+    
+    friend bool operator==(const SmallBuffer& a, const SmallBuffer& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+    
+    friend bool operator==(const SmallBuffer& a, const std::vector<uint8_t>& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+    
+    friend bool operator==(const std::vector<uint8_t>& a, const SmallBuffer& b) {
+        return b == a;
+    }
+    
+    friend bool operator!=(const SmallBuffer& a, const SmallBuffer& b) { return !(a == b); }
+    friend bool operator!=(const SmallBuffer& a, const std::vector<uint8_t>& b) { return !(a == b); }
+    friend bool operator!=(const std::vector<uint8_t>& a, const SmallBuffer& b) { return !(b == a); }
+
+private:
+    //! Steal heap storage, or copy inline contents, leaving other empty and inline
+    void takeFrom(SmallBuffer& other) noexcept {
+        if (other.isInline()) {
+            std::memcpy(inline_, other.inline_, N); //! Fixed-size copy, cheaper than a variable one
+            size_ = other.size_;
+        } else {
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inline_;
+            other.capacity_ = N;
+        }
+        other.size_ = 0;
+    }
+    
+    uint8_t* data_;
+    size_t size_;
+    size_t capacity_;
+    uint8_t inline_[N];
+};
+
+//! Payload storage for received packets
+using PayloadBuffer = SmallBuffer<SERIALFLEX_INLINE_PAYLOAD_SIZE>;
+
 //! --------------------------------
 //! CRC IMPLEMENTATION
 //! --------------------------------
 
+namespace detail {
+    //! Slicing-by-4 tables for CRC-16 CCITT: table[k][b] is the zero-init CRC of
+    //! byte b followed by k zero bytes
+    constexpr std::array<std::array<uint16_t, 256>, 4> makeCRC16Tables() {
+        std::array<std::array<uint16_t, 256>, 4> tables{};
+        for (uint16_t b = 0; b < 256; b++) {
+            uint16_t crc = static_cast<uint16_t>(b << 8);
+            for (uint8_t j = 0; j < 8; j++) {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) 
+                                     : static_cast<uint16_t>(crc << 1);
+            }
+            tables[0][b] = crc;
+        }
+        for (size_t k = 1; k < 4; k++) {
+            for (uint16_t b = 0; b < 256; b++) {
+                uint16_t prev = tables[k - 1][b];
+                tables[k][b] = static_cast<uint16_t>((prev << 8) ^ tables[0][prev >> 8]);
+            }
+        }
+        return tables;
+    }
+    
+    inline constexpr std::array<std::array<uint16_t, 256>, 4> CRC16_TABLES = makeCRC16Tables();
+}
+
+//! All CRC routines are constexpr, so checksums of constant data cost nothing at runtime
 class CRC {
 public:
     //! Calculate CRC-16 (CCITT) - standard implementation
-    static uint16_t calculateCRC16(const uint8_t* data, size_t length) {
-        uint16_t crc = 0xFFFF; //! Initial value
+    static constexpr uint16_t calculateCRC16(const uint8_t* data, size_t length) {
+        return updateCRC16(0xFFFF, data, length); //! Initial value 0xFFFF
+    }
+    
+    //! Continue a CRC-16 (CCITT) over more data, for streaming/byte-wise use
+    //! Table driven (CCITT polynomial: x^16 + x^12 + x^5 + 1), four bytes per step
+    static constexpr uint16_t updateCRC16(uint16_t crc, const uint8_t* data, size_t length) {
+        const auto& t = detail::CRC16_TABLES;
+        size_t i = 0;
         
-        for (size_t i = 0; i < length; i++) {
-            crc ^= static_cast<uint16_t>(data[i]) << 8;
-            
-            for (uint8_t j = 0; j < 8; j++) {
-                if (crc & 0x8000) {
-                    crc = (crc << 1) ^ 0x1021; //! CCITT polynomial: x^16 + x^12 + x^5 + 1
-                } else {
-                    crc = crc << 1;
-                }
-            }
+        for (; i + 4 <= length; i += 4) {
+            crc = static_cast<uint16_t>(t[3][(crc >> 8) ^ data[i]] ^ t[2][(crc & 0xFF) ^ data[i + 1]] ^
+                                        t[1][data[i + 2]] ^ t[0][data[i + 3]]);
+        }
+        for (; i < length; i++) {
+            crc = static_cast<uint16_t>((crc << 8) ^ t[0][(crc >> 8) ^ data[i]]);
         }
         
         return crc;
     }
     
+    static constexpr uint16_t updateCRC16(uint16_t crc, uint8_t byte) {
+        return updateCRC16(crc, &byte, 1);
+    }
+    
+    //! CRC-16 is linear: for equal-length messages, CRC(A ^ D) == CRC(A) ^ CRC0(D), where
+    //! CRC0 runs with a zero initial value. This returns CRC0 of `delta` followed by
+    //! `trailingBytes` zero bytes in O(log n), so a changed byte can be folded into an
+    //! existing CRC without touching the rest of the message.
+    static constexpr uint16_t crc16ByteContribution(uint8_t delta, size_t trailingBytes) {
+        uint16_t single = updateCRC16(0, delta);
+        
+        //! Multiply by x^(8 * trailingBytes) mod P using square-and-multiply
+        uint16_t power = 1;
+        uint16_t base = 0x0100; //! x^8
+        for (size_t n = trailingBytes; n > 0; n >>= 1) {
+            if (n & 1) {
+                power = multiplyCRC16(power, base);
+            }
+            base = multiplyCRC16(base, base);
+        }
+        return multiplyCRC16(single, power);
+    }
+    
+    //! Polynomial product a * b mod the CCITT polynomial
+    static constexpr uint16_t multiplyCRC16(uint16_t a, uint16_t b) {
+        uint16_t result = 0;
+        for (int bit = 15; bit >= 0; bit--) {
+            result = (result & 0x8000) ? static_cast<uint16_t>((result << 1) ^ 0x1021) 
+                                       : static_cast<uint16_t>(result << 1);
+            if (a & (1u << bit)) {
+                result ^= b;
+            }
+        }
+        return result;
+    }
+    
     //! Calculate CRC-32 (IEEE 802.3)
-    static uint32_t calculateCRC32(const uint8_t* data, size_t length) {
+    static constexpr uint32_t calculateCRC32(const uint8_t* data, size_t length) {
         uint32_t crc = 0xFFFFFFFF; //! Initial value
         
         for (size_t i = 0; i < length; i++) {
@@ -56,7 +362,7 @@ public:
     }
     
     //! Calculate CRC-8
-    static uint8_t calculateCRC8(const uint8_t* data, size_t length) {
+    static constexpr uint8_t calculateCRC8(const uint8_t* data, size_t length) {
         uint8_t crc = 0xFF; //! Initial value
         
         for (size_t i = 0; i < length; i++) {
@@ -127,6 +433,17 @@ namespace detail {
         
     template<typename T, typename V>
     std::false_type has_push_back_impl(...);
+    
+    //! Test for contiguous storage that can be resized and written through data()
+    template<typename T>
+    auto has_contiguous_storage_impl(int) 
+        -> decltype(std::declval<T&>().resize(std::size_t{}),
+                    std::enable_if_t<std::is_same_v<decltype(std::declval<T&>().data()),
+                                                     typename T::value_type*>>(),
+                    std::true_type{});
+        
+    template<typename T>
+    std::false_type has_contiguous_storage_impl(...);
 }
 
 //! Public type traits
@@ -147,41 +464,47 @@ using has_reserve = decltype(detail::has_reserve_impl<T>(0));
 template<typename T, typename V>
 using has_push_back = decltype(detail::has_push_back_impl<T, V>(0));
 
+//! Contiguous container of trivially copyable elements (std::string, std::vector<float>, ...)
+//! whose elements can be copied as one block
+template<typename T>
+struct is_bulk_copyable_container {
+    static constexpr bool value = decltype(detail::has_contiguous_storage_impl<T>(0))::value &&
+                                  std::is_trivially_copyable_v<typename T::value_type>;
+};
+
 //! --------------------------------
 //! SERIALIZATION IMPLEMENTATION
 //! --------------------------------
 
-//! Forward declaration
-template<typename T>
-std::vector<uint8_t> serialize(const T& data);
-
-//! Main serialization function
+//! Append the serialized form of data to out
 template<typename T>
-std::vector<uint8_t> serialize(const T& data) {
+void appendSerialized(std::vector<uint8_t>& out, const T& data) {
     if constexpr (std::is_trivially_copyable_v<T>) {
         //! For POD types, direct memory copy
         const uint8_t* begin = reinterpret_cast<const uint8_t*>(&data);
-        return std::vector<uint8_t>(begin, begin + sizeof(T));
+        out.insert(out.end(), begin, begin + sizeof(T));
     } 
     else if constexpr (is_container<T>::value) {
         //! For containers like vector, string, etc.
-        std::vector<uint8_t> result;
-        
         //! Serialize container size (32-bit)
         uint32_t size = static_cast<uint32_t>(data.size());
         const uint8_t* sizePtr = reinterpret_cast<const uint8_t*>(&size);
-        result.insert(result.end(), sizePtr, sizePtr + sizeof(size));
+        out.insert(out.end(), sizePtr, sizePtr + sizeof(size));
         
-        //! Serialize each element
-        for (const auto& element : data) {
-            auto elementBytes = serialize(element);
-            result.insert(result.end(), elementBytes.begin(), elementBytes.end());
+        //! Serialize each element; plain element types go in as one block
+        if constexpr (is_bulk_copyable_container<T>::value) {
+            const uint8_t* elements = reinterpret_cast<const uint8_t*>(data.data());
+            out.insert(out.end(), elements, elements + data.size() * sizeof(typename T::value_type));
+        } else {
+            for (const auto& element : data) {
+                appendSerialized(out, element);
+            }
         }
-        return result;
     } 
     else if constexpr (has_serialize_method<T>::value) {
         //! For custom types with their own serialize method
-        return data.serialize();
+        std::vector<uint8_t> bytes = data.serialize();
+        out.insert(out.end(), bytes.begin(), bytes.end());
     } 
     else {
         //! Fallback for complex types without a serialize method
@@ -189,7 +512,27 @@ std::vector<uint8_t> serialize(const T& data) {
                      is_container<T>::value || 
                      has_serialize_method<T>::value,
             "Type must be trivially copyable, a container, or have a serialize method");
-        return {}; //! Unreachable, but makes compiler happy
+    }
+}
+
+//! Serialize into a reused buffer. Once out has grown to the message size this
+//! allocates nothing, except what a custom serialize method returns.
+template<typename T>
+void serializeInto(std::vector<uint8_t>& out, const T& data) {
+    out.clear();
+    appendSerialized(out, data);
+}
+
+//! Main serialization function
+template<typename T>
+std::vector<uint8_t> serialize(const T& data) {
+    if constexpr (!std::is_trivially_copyable_v<T> && !is_container<T>::value && has_serialize_method<T>::value) {
+        //! Custom serialize methods already return the buffer
+        return data.serialize();
+    } else {
+        std::vector<uint8_t> result;
+        appendSerialized(result, data);
+        return result;
     }
 }
 
@@ -197,6 +540,55 @@ std::vector<uint8_t> serialize(const T& data) {
 //! PACKET FRAMING
 //! --------------------------------
 
+//! Result of validating or receiving a frame
+enum class FrameStatus : uint8_t {
+    Ok,
+    TooSmall,        //! Fewer bytes than the smallest possible frame
+    InvalidMarkers,  //! Missing START_BYTE/END_BYTE
+    LengthMismatch,  //! Stuffed payload does not match the length field
+    CrcMismatch,     //! Checksum failed
+    BufferOverflow,  //! Payload larger than the receiver accepts
+    UnexpectedStart  //! Frame cut short by a new START_BYTE
+};
+
+//! Human-readable description of a frame status
+inline const char* toString(FrameStatus status) {
+    switch (status) {
+        case FrameStatus::Ok:              return "OK";
+        case FrameStatus::TooSmall:        return "Packet too small";
+        case FrameStatus::InvalidMarkers:  return "Invalid frame markers";
+        case FrameStatus::LengthMismatch:  return "Length mismatch";
+        case FrameStatus::CrcMismatch:     return "CRC mismatch";
+        case FrameStatus::BufferOverflow:  return "Buffer overflow";
+        case FrameStatus::UnexpectedStart: return "Unexpected start byte";
+    }
+    return "Unknown error";
+}
+
+//! Validation result that borrows from the frame buffer instead of copying the payload
+struct FrameView {
+    uint8_t messageId = 0;
+    uint16_t length = 0;                  //! Payload length from the header (unstuffed)
+    ByteSpan payload;                     //! Payload as it appears on the wire (also set for CrcMismatch)
+    ByteSpan frame;                       //! Whole frame, START_BYTE to END_BYTE (also set for CrcMismatch)
+    FrameStatus status = FrameStatus::TooSmall;
+    
+    bool valid() const {
+        return status == FrameStatus::Ok;
+    }
+    
+    //! When false, payload is byte-identical to the decoded payload and can be read in place
+    bool stuffed() const {
+        return payload.size() != length;
+    }
+};
+
+//! Counts returned by batch validation
+struct ValidationSummary {
+    size_t validFrames = 0;
+    size_t invalidFrames = 0;
+};
+
 class PacketFramer {
 public:
     //! Constants for packet structure
@@ -204,151 +596,455 @@ public:
     static constexpr uint8_t END_BYTE = 0x7D;
     static constexpr uint8_t ESCAPE_BYTE = 0x7C;
     
+    //! Largest payload the 16-bit length field can describe
+    static constexpr size_t MAX_PAYLOAD_SIZE = 0xFFFF;
+    
     //! Frame a payload with start/end bytes and byte stuffing
     static std::vector<uint8_t> framePacket(uint8_t messageId, const std::vector<uint8_t>& payload) {
         std::vector<uint8_t> packet;
-        packet.reserve(payload.size() + 10); //! Reserve space for overhead
+        framePacketInto(packet, messageId, ByteSpan(payload));
+        return packet;
+    }
+    
+    //! Frame a payload given as up to two consecutive pieces into out, reusing its capacity
+    static void framePacketInto(std::vector<uint8_t>& out, uint8_t messageId, 
+                                ByteSpan head, ByteSpan tail = ByteSpan()) {
+        out.clear();
+        appendPacket(out, messageId, head, tail);
+    }
+    
+    //! Frame a payload and append it to out, after any packets already there
+    static void appendPacket(std::vector<uint8_t>& out, uint8_t messageId, 
+                             ByteSpan head, ByteSpan tail = ByteSpan()) {
+        size_t payloadSize = head.size() + tail.size();
+        if (payloadSize > MAX_PAYLOAD_SIZE) {
+            throw std::length_error("Payload exceeds 16-bit length field");
+        }
+        
+        //! Reserve space for overhead, growing geometrically when appending many packets
+        size_t start = out.size();
+        size_t needed = start + payloadSize + 10;
+        if (needed > out.capacity()) {
+            out.reserve(std::max(needed, out.capacity() * 2));
+        }
         
-        packet.push_back(START_BYTE);
-        packet.push_back(messageId);
+        out.push_back(START_BYTE);
+        out.push_back(messageId);
         
         //! Add length (16-bit, little endian)
-        uint16_t dataSize = static_cast<uint16_t>(payload.size());
-        packet.push_back(static_cast<uint8_t>(dataSize & 0xFF));
-        packet.push_back(static_cast<uint8_t>((dataSize >> 8) & 0xFF));
+        uint16_t dataSize = static_cast<uint16_t>(payloadSize);
+        out.push_back(static_cast<uint8_t>(dataSize & 0xFF));
+        out.push_back(static_cast<uint8_t>((dataSize >> 8) & 0xFF));
         
         //! Add data with byte stuffing
-        for (uint8_t byte : payload) {
-            if (byte == START_BYTE || byte == END_BYTE || byte == ESCAPE_BYTE) {
-                packet.push_back(ESCAPE_BYTE);
-                packet.push_back(byte ^ 0x20); //! XOR for escaping
-            } else {
-                packet.push_back(byte);
-            }
-        }
+        appendStuffed(out, head);
+        appendStuffed(out, tail);
         
         //! Add CRC-16 (CCITT)
-        uint16_t crc = CRC::calculateCRC16(packet.data() + 1, packet.size() - 1);
-        packet.push_back(static_cast<uint8_t>(crc & 0xFF));
-        packet.push_back(static_cast<uint8_t>((crc >> 8) & 0xFF));
+        uint16_t crc = CRC::calculateCRC16(out.data() + start + 1, out.size() - start - 1);
+        out.push_back(static_cast<uint8_t>(crc & 0xFF));
+        out.push_back(static_cast<uint8_t>((crc >> 8) & 0xFF));
         
         //! Add end byte
-        packet.push_back(END_BYTE);
+        out.push_back(END_BYTE);
+    }
+    
+    //! Check whether a payload byte must be escaped on the wire
+    static constexpr bool needsEscape(uint8_t byte) {
+        return byte == START_BYTE || byte == END_BYTE || byte == ESCAPE_BYTE;
+    }
+    
+    //! Check whether any payload byte must be escaped; memchr keeps this at memory speed
+    static bool needsStuffing(ByteSpan data) {
+        return !data.empty() && (std::memchr(data.data(), START_BYTE, data.size()) != nullptr ||
+                                 std::memchr(data.data(), END_BYTE, data.size()) != nullptr ||
+                                 std::memchr(data.data(), ESCAPE_BYTE, data.size()) != nullptr);
+    }
+    
+    //! A frame in three pieces for scatter-gather output (writev/sendmsg): header and
+    //! trailer are stored here, the payload stays in the caller's memory
+    struct ScatterFrame {
+        std::array<uint8_t, 4> header{};  //! START, ID, LEN[2]
+        ByteSpan payload;
+        std::array<uint8_t, 3> trailer{}; //! CRC[2], END
         
-        return packet;
+        size_t size() const {
+            return header.size() + payload.size() + trailer.size();
+        }
+    };
+    
+    //! Frame a payload without copying it. An unstuffed payload is sent as is, so
+    //! only the header and trailer are built. Returns false when the payload needs
+    //! stuffing; frame those with framePacketInto instead.
+    static bool frameScatter(ScatterFrame& frame, uint8_t messageId, ByteSpan payload) {
+        if (payload.size() > MAX_PAYLOAD_SIZE) {
+            throw std::length_error("Payload exceeds 16-bit length field");
+        }
+        if (needsStuffing(payload)) {
+            return false;
+        }
+        
+        frame.header = {START_BYTE, messageId, static_cast<uint8_t>(payload.size() & 0xFF),
+                        static_cast<uint8_t>((payload.size() >> 8) & 0xFF)};
+        frame.payload = payload;
+        
+        uint16_t crc = CRC::calculateCRC16(frame.header.data() + 1, 3);
+        crc = CRC::updateCRC16(crc, payload.data(), payload.size());
+        frame.trailer = {static_cast<uint8_t>(crc & 0xFF), static_cast<uint8_t>((crc >> 8) & 0xFF), END_BYTE};
+        return true;
     }
     
     //! Structure to hold deframed packet data
     struct DeframedPacket {
-        uint8_t messageId;
-        std::vector<uint8_t> payload;
-        bool valid;
-        std::string errorReason;
+        PayloadBuffer payload;
+        uint8_t messageId = 0;
+        FrameStatus status = FrameStatus::TooSmall;
+        
+        bool valid() const {
+            return status == FrameStatus::Ok;
+        }
+        
+        //! Formatted on demand; rejected frames never allocate a message
+        const char* errorReason() const {
+            return toString(status);
+        }
     };
     
-    //! Process a complete framed packet
-    static DeframedPacket deframePacket(const std::vector<uint8_t>& packet) {
-        DeframedPacket result;
-        result.valid = false;
-        
+    //! Check a complete framed packet without copying its payload.
+    //! The header and CRC are sent raw; only the payload is stuffed, so the
+    //! length field tells where the payload ends on the wire.
+    static FrameView validateFrame(ByteSpan packet) {
         //! Basic validation
         if (packet.size() < 7) { //! Minimum packet size (START + ID + LEN[2] + CRC[2] + END)
-            result.errorReason = "Packet too small";
-            return result;
+            FrameView view;
+            view.status = FrameStatus::TooSmall;
+            return view;
         }
         
-        if (packet[0] != START_BYTE || packet.back() != END_BYTE) {
-            result.errorReason = "Invalid frame markers";
-            return result;
+        if (packet[0] != START_BYTE || packet[packet.size() - 1] != END_BYTE) {
+            FrameView view;
+            view.status = FrameStatus::InvalidMarkers;
+            return view;
         }
         
-        //! Extract message ID
-        result.messageId = packet[1];
-        
-        //! Extract length
-        uint16_t length = static_cast<uint16_t>(packet[2]) | 
-                         (static_cast<uint16_t>(packet[3]) << 8);
-                         
-        //! Verify packet size matches expected length
-        size_t expectedPacketSize = length + 7; //! START + ID + LEN[2] + DATA[length] + CRC[2] + END
-        if (packet.size() != expectedPacketSize) {
-            result.errorReason = "Length mismatch";
-            return result;
+        return scanFrame(packet.data(), packet.size(), true);
+    }
+    
+    //! Check the frame starting at buffer[0], which may be followed by more data
+    static FrameView validateLeadingFrame(ByteSpan buffer) {
+        if (!buffer.empty() && buffer[0] != START_BYTE) {
+            FrameView view;
+            view.status = FrameStatus::InvalidMarkers;
+            return view;
         }
+        return scanFrame(buffer.data(), buffer.size(), false);
+    }
+    
+    //! Validate every frame in a captured buffer, calling callback(const FrameView&)
+    //! for each START_BYTE that begins a frame candidate. Invalid candidates are
+    //! skipped by one byte so a real frame hidden behind garbage is still found.
+    template<typename Callback>
+    static ValidationSummary validateFrames(ByteSpan buffer, Callback&& callback) {
+        ValidationSummary summary;
+        const uint8_t* data = buffer.data();
+        size_t pos = 0;
         
-        //! Verify CRC
-        size_t crcPos = packet.size() - 3;
-        uint16_t receivedCrc = static_cast<uint16_t>(packet[crcPos]) | 
-                              (static_cast<uint16_t>(packet[crcPos + 1]) << 8);
-        uint16_t calculatedCrc = CRC::calculateCRC16(packet.data() + 1, crcPos - 1);
-        
-        if (receivedCrc != calculatedCrc) {
-            result.errorReason = "CRC mismatch";
-            return result;
+        while (pos < buffer.size()) {
+            const void* start = std::memchr(data + pos, START_BYTE, buffer.size() - pos);
+            if (start == nullptr) {
+                break;
+            }
+            pos = static_cast<size_t>(static_cast<const uint8_t*>(start) - data);
+            
+            FrameView view = scanFrame(data + pos, buffer.size() - pos, false);
+            callback(static_cast<const FrameView&>(view));
+            if (view.valid()) {
+                summary.validFrames++;
+                pos += view.frame.size();
+            } else {
+                summary.invalidFrames++;
+                pos++;
+            }
         }
         
-        //! Extract data portion (excluding header, CRC, and end byte)
-        result.payload = std::vector<uint8_t>(packet.begin() + 4, packet.begin() + crcPos);
-        result.valid = true;
+        return summary;
+    }
+    
+    //! Count valid and invalid frames in a captured buffer
+    static ValidationSummary validateFrames(ByteSpan buffer) {
+        return validateFrames(buffer, [](const FrameView&) {});
+    }
+    
+    //! Process a complete framed packet. With keepCorruptPayload, a frame that only
+    //! fails the CRC check still gets its payload, with status CrcMismatch (as with
+    //! PacketReceiver::setKeepCorruptPayloads).
+    static DeframedPacket deframePacket(ByteSpan packet, bool keepCorruptPayload = false) {
+        DeframedPacket result;
+        FrameView view = validateFrame(packet);
+        result.messageId = view.messageId;
+        result.status = view.status;
+        if (result.valid() || (keepCorruptPayload && result.status == FrameStatus::CrcMismatch)) {
+            unstuffPayload(view, result.payload);
+        }
         return result;
     }
     
+    //! Extract the data portion of a validated frame, undoing byte stuffing
+    static void unstuffPayload(const FrameView& view, PayloadBuffer& out) {
+        if (!view.stuffed()) {
+            out.assign(view.payload.begin(), view.payload.end());
+            return;
+        }
+        
+        out.clear();
+        out.reserve(view.length);
+        for (size_t i = 0; i < view.payload.size(); i++) {
+            uint8_t byte = view.payload[i];
+            out.push_back(byte == ESCAPE_BYTE ? view.payload[++i] ^ 0x20 : byte);
+        }
+    }
+    
     //! Stateful packet receiver to process byte-by-byte
     class PacketReceiver {
     public:
-        PacketReceiver() : inPacket_(false), escapeNext_(false) {}
+        //! Default cap on accepted payloads; larger messages should be fragmented
+        static constexpr size_t DEFAULT_MAX_PAYLOAD_SIZE = 1024;
+        
+        explicit PacketReceiver(size_t maxPayloadSize = DEFAULT_MAX_PAYLOAD_SIZE) 
+            : maxPayloadSize_(maxPayloadSize), state_(State::Idle), escapeNext_(false),
+              keepCorruptPayloads_(false), messageId_(0), length_(0), crc_(0), receivedCrc_(0) {}
         
         //! Process a single byte, returns true if a complete packet was received
         bool processByte(uint8_t byte, DeframedPacket& outPacket) {
-            static const size_t MAX_PACKET_SIZE = 1024;
-            
-            if (!inPacket_ && byte == START_BYTE) {
-                buffer_.clear();
-                buffer_.push_back(byte);
-                inPacket_ = true;
-                escapeNext_ = false;
+            switch (state_) {
+            case State::Idle:
+                if (byte == START_BYTE) {
+                    beginFrame();
+                }
+                return false;
+                
+            case State::MessageId:
+                messageId_ = byte;
+                crc_ = CRC::updateCRC16(crc_, byte);
+                state_ = State::LengthLow;
+                return false;
+                
+            case State::LengthLow:
+                length_ = byte;
+                crc_ = CRC::updateCRC16(crc_, byte);
+                state_ = State::LengthHigh;
+                return false;
+                
+            case State::LengthHigh:
+                length_ |= static_cast<uint16_t>(byte) << 8;
+                crc_ = CRC::updateCRC16(crc_, byte);
+                
+                //! Safety check for buffer overflow
+                if (length_ > maxPayloadSize_) {
+                    state_ = State::Idle;
+                    return reject(outPacket, FrameStatus::BufferOverflow);
+                }
+                state_ = length_ > 0 ? State::Payload : State::CrcLow;
                 return false;
-            } 
-            else if (inPacket_) {
+                
+            case State::Payload:
+                if (byte == START_BYTE) {
+                    //! A raw start byte never appears inside a payload: resynchronize
+                    beginFrame();
+                    return reject(outPacket, FrameStatus::UnexpectedStart);
+                }
+                crc_ = CRC::updateCRC16(crc_, byte);
+                
                 if (escapeNext_) {
                     buffer_.push_back(byte ^ 0x20); //! Unescape
                     escapeNext_ = false;
                 } 
                 else if (byte == ESCAPE_BYTE) {
                     escapeNext_ = true;
+                    return false;
                 } 
                 else if (byte == END_BYTE) {
-                    buffer_.push_back(byte);
-                    outPacket = deframePacket(buffer_);
-                    inPacket_ = false;
-                    return true;
+                    state_ = State::Idle;
+                    return reject(outPacket, FrameStatus::LengthMismatch);
                 } 
                 else {
                     buffer_.push_back(byte);
                 }
                 
-                //! Safety check for buffer overflow
-                if (buffer_.size() > MAX_PACKET_SIZE) {
-                    inPacket_ = false;
-                    outPacket.valid = false;
-                    outPacket.errorReason = "Buffer overflow";
+                if (buffer_.size() == length_) {
+                    state_ = State::CrcLow;
+                }
+                return false;
+                
+            case State::CrcLow:
+                receivedCrc_ = byte;
+                state_ = State::CrcHigh;
+                return false;
+                
+            case State::CrcHigh:
+                receivedCrc_ |= static_cast<uint16_t>(byte) << 8;
+                state_ = State::End;
+                return false;
+                
+            case State::End:
+                state_ = State::Idle;
+                if (byte != END_BYTE) {
+                    if (byte == START_BYTE) {
+                        beginFrame();
+                    }
+                    return reject(outPacket, FrameStatus::InvalidMarkers);
+                }
+                if (receivedCrc_ != crc_) {
+                    if (!keepCorruptPayloads_) {
+                        return reject(outPacket, FrameStatus::CrcMismatch);
+                    }
+                    //! Hand the damaged payload over for repair (e.g. by FecCodec)
+                    outPacket.messageId = messageId_;
+                    outPacket.payload.swap(buffer_);
+                    outPacket.status = FrameStatus::CrcMismatch;
                     return true;
                 }
+                
+                //! Hand the buffer over; the caller's old storage is recycled for the next frame
+                outPacket.messageId = messageId_;
+                outPacket.payload.swap(buffer_);
+                outPacket.status = FrameStatus::Ok;
+                return true;
             }
             
             return false;
         }
         
+        //! Largest payload this receiver accepts
+        size_t maxPayloadSize() const {
+            return maxPayloadSize_;
+        }
+        
+        //! Deliver the payload of frames failing the CRC check instead of clearing it.
+        //! Their status stays CrcMismatch, so callers that only check valid() are unaffected.
+        void setKeepCorruptPayloads(bool keep) {
+            keepCorruptPayloads_ = keep;
+        }
+        
+        //! True while the receiver is between the header and the CRC of a frame
+        bool inPayload() const {
+            return state_ == State::Payload;
+        }
+        
     private:
-        std::vector<uint8_t> buffer_;
-        bool inPacket_;
+        enum class State : uint8_t {
+            Idle,
+            MessageId,
+            LengthLow,
+            LengthHigh,
+            Payload,
+            CrcLow,
+            CrcHigh,
+            End
+        };
+        
+        void beginFrame() {
+            buffer_.clear();
+            state_ = State::MessageId;
+            escapeNext_ = false;
+            crc_ = 0xFFFF;
+        }
+        
+        static bool reject(DeframedPacket& outPacket, FrameStatus status) {
+            outPacket.status = status;
+            outPacket.payload.clear();
+            return true;
+        }
+        
+        PayloadBuffer buffer_;
+        size_t maxPayloadSize_;
+        State state_;
         bool escapeNext_;
+        bool keepCorruptPayloads_;
+        uint8_t messageId_;
+        uint16_t length_;
+        uint16_t crc_;
+        uint16_t receivedCrc_;
     };
-};
-
-//! --------------------------------
-//! DESERIALIZATION IMPLEMENTATION
-//! --------------------------------
+
+private:
+    //! Parse the frame beginning at data[0]. With exactSize the frame must span all
+    //! available bytes; otherwise it may be followed by more data.
+    static FrameView scanFrame(const uint8_t* data, size_t available, bool exactSize) {
+        FrameView view;
+        if (available < 7) {
+            view.status = FrameStatus::TooSmall;
+            return view;
+        }
+        
+        view.messageId = data[1];
+        view.length = static_cast<uint16_t>(data[2] | (static_cast<uint16_t>(data[3]) << 8));
+        
+        //! Locate the end of the stuffed payload; without escapes it is simply 4 + length
+        size_t limit = available - 3;
+        size_t pos = 4 + view.length;
+        if (pos > limit || std::memchr(data + 4, ESCAPE_BYTE, view.length) != nullptr) {
+            //! Jump from escape to escape; each escape pair yields one payload byte
+            pos = 4;
+            size_t remaining = view.length;
+            while (remaining > 0) {
+                size_t window = std::min(remaining, limit - pos);
+                const void* escape = std::memchr(data + pos, ESCAPE_BYTE, window);
+                if (escape == nullptr) {
+                    pos += remaining;
+                    remaining = window < remaining ? remaining : 0;
+                    break;
+                }
+                size_t run = static_cast<size_t>(static_cast<const uint8_t*>(escape) - (data + pos));
+                pos += run + 2;
+                remaining -= run + 1;
+                if (pos > limit) {
+                    break;
+                }
+            }
+            if (remaining > 0 || pos > limit) {
+                view.status = exactSize ? FrameStatus::LengthMismatch : FrameStatus::TooSmall;
+                return view;
+            }
+        }
+        
+        if (exactSize && pos != limit) {
+            view.status = FrameStatus::LengthMismatch;
+            return view;
+        }
+        if (data[pos + 2] != END_BYTE) {
+            view.status = FrameStatus::InvalidMarkers;
+            return view;
+        }
+        
+        view.payload = ByteSpan(data + 4, pos - 4);
+        view.frame = ByteSpan(data, pos + 3);
+        
+        //! Verify CRC (computed over the on-wire bytes from MSG_ID to the end of PAYLOAD)
+        uint16_t receivedCrc = static_cast<uint16_t>(data[pos] | (static_cast<uint16_t>(data[pos + 1]) << 8));
+        if (receivedCrc != CRC::calculateCRC16(data + 1, pos - 1)) {
+            view.status = FrameStatus::CrcMismatch;
+            return view;
+        }
+        view.status = FrameStatus::Ok;
+        return view;
+    }
+    
+    static void appendStuffed(std::vector<uint8_t>& out, ByteSpan data) {
+        for (uint8_t byte : data) {
+            if (needsEscape(byte)) {
+                out.push_back(ESCAPE_BYTE);
+                out.push_back(byte ^ 0x20); //! XOR for escaping
+            } else {
+                out.push_back(byte);
+            }
+        }
+    }
+};
+
+//! --------------------------------
+//! DESERIALIZATION IMPLEMENTATION
+//! --------------------------------
 
 //! Exception for deserialization errors
 class DeserializationError : public std::runtime_error {
@@ -359,7 +1055,8 @@ public:
 //! Helper class for tracking deserialization position
 class ByteReader {
 public:
-    ByteReader(const std::vector<uint8_t>& data) : data_(data), pos_(0) {}
+    ByteReader(ByteSpan data) : data_(data), pos_(0) {}
+    ByteReader(const uint8_t* data, size_t size) : data_(data, size), pos_(0) {}
     
     template<typename T>
     T read() {
@@ -375,12 +1072,23 @@ public:
         return value;
     }
     
-    std::vector<uint8_t> readBytes(size_t count) {
+    PayloadBuffer readBytes(size_t count) {
+        if (pos_ + count > data_.size()) {
+            throw DeserializationError("Not enough data to read");
+        }
+        
+        PayloadBuffer result(data_.begin() + pos_, data_.begin() + pos_ + count);
+        pos_ += count;
+        return result;
+    }
+    
+    //! Borrow the next count bytes without copying; valid as long as the source data
+    ByteSpan readView(size_t count) {
         if (pos_ + count > data_.size()) {
             throw DeserializationError("Not enough data to read");
         }
         
-        std::vector<uint8_t> result(data_.begin() + pos_, data_.begin() + pos_ + count);
+        ByteSpan result = data_.subspan(pos_, count);
         pos_ += count;
         return result;
     }
@@ -394,7 +1102,7 @@ public:
     }
 
 private:
-    const std::vector<uint8_t>& data_;
+    ByteSpan data_;
     size_t pos_;
 };
 
@@ -417,9 +1125,21 @@ T deserialize(ByteReader& reader) {
         uint32_t size = reader.read<uint32_t>();
         
         T container;
-        //! Reserve space if the container supports it
+        
+        //! Plain elements: one size check, one allocation, one copy
+        if constexpr (is_bulk_copyable_container<T>::value) {
+            if (size > reader.remaining() / sizeof(ValueType)) {
+                throw DeserializationError("Not enough data to read");
+            }
+            ByteSpan bytes = reader.readView(size * sizeof(ValueType));
+            container.resize(size);
+            std::memcpy(container.data(), bytes.data(), bytes.size());
+            return container;
+        }
+        
+        //! Reserve space if the container supports it (every element takes at least one byte)
         if constexpr (has_reserve<T>::value) {
-            container.reserve(size);
+            container.reserve(std::min<size_t>(size, reader.remaining()));
         }
         
         //! Deserialize each element
@@ -442,9 +1162,9 @@ T deserialize(ByteReader& reader) {
     }
 }
 
-//! Overload for vector of bytes
+//! Overload for contiguous bytes: std::vector, PayloadBuffer, or a payload still inside a frame buffer
 template<typename T>
-T deserialize(const std::vector<uint8_t>& data) {
+T deserialize(ByteSpan data) {
     ByteReader reader(data);
     return deserialize<T>(reader);
 }
@@ -460,24 +1180,1321 @@ std::vector<uint8_t> createPacket(uint8_t messageId, const T& data) {
     return PacketFramer::framePacket(messageId, serialized);
 }
 
-//! Convenience wrapper for deframing and deserializing in one step
+//! Deframe and deserialize into out, which is only assigned (by move) on success.
+//! Payloads that needed no stuffing are decoded straight from the frame, so the
+//! only allocations are the ones T itself owns.
 template<typename T>
-std::pair<bool, T> parsePacket(const std::vector<uint8_t>& packetData) {
-    auto deframed = PacketFramer::deframePacket(packetData);
-    if (!deframed.valid) {
-        return {false, T{}};
+bool parsePacket(ByteSpan packetData, T& out) {
+    FrameView view = PacketFramer::validateFrame(packetData);
+    if (!view.valid()) {
+        return false;
     }
     
     try {
-        T data = deserialize<T>(deframed.payload);
-        return {true, data};
-    } catch (const DeserializationError& e) {
-        return {false, T{}};
+        if (!view.stuffed()) {
+            out = deserialize<T>(view.payload);
+        } else {
+            PayloadBuffer payload;
+            PacketFramer::unstuffPayload(view, payload);
+            out = deserialize<T>(payload);
+        }
+    } catch (const DeserializationError&) {
+        return false;
     }
+    return true;
+}
+
+//! Convenience wrapper for deframing and deserializing in one step
+template<typename T>
+std::pair<bool, T> parsePacket(ByteSpan packetData) {
+    std::pair<bool, T> result{};
+    result.first = parsePacket(packetData, result.second);
+    return result;
 }
 
 //! Type aliases for convenience
 using DeframedPacket = PacketFramer::DeframedPacket;
 using PacketReceiver = PacketFramer::PacketReceiver;
 
+//! --------------------------------
+//! MESSAGE DISPATCH
+//! --------------------------------
+
+//! Binds a message ID to the type carried in its payload
+template<uint8_t Id, typename T>
+struct Message {
+    static constexpr uint8_t id = Id;
+    using type = T;
+};
+
+//! Outcome of routing a packet through a MessageRegistry
+enum class DispatchResult : uint8_t {
+    Handled,        //! Payload decoded and handler invoked
+    UnknownMessage, //! No type registered for the message ID
+    InvalidPacket,  //! Packet failed frame validation
+    DecodeError     //! Payload could not be deserialized into the registered type
+};
+
+//! Combine several lambdas into one handler: overloaded{[](const A&){}, [](const B&){}}
+template<typename... Fs>
+struct overloaded : Fs... {
+    using Fs::operator()...;
+};
+
+template<typename... Fs>
+overloaded(Fs...) -> overloaded<Fs...>;
+
+namespace detail {
+    template<size_t N>
+    constexpr bool hasUniqueIds(const std::array<uint8_t, N>& ids) {
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = i + 1; j < N; j++) {
+                if (ids[i] == ids[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+//! Compile-time map from message IDs to payload types.
+//! Dispatch goes through a 256-entry function pointer table generated from the
+//! type list, so routing a packet is one indexed load and one direct call.
+template<typename... Messages>
+class MessageRegistry {
+    static_assert(sizeof...(Messages) > 0, "Registry needs at least one message binding");
+    static_assert(detail::hasUniqueIds(std::array<uint8_t, sizeof...(Messages)>{Messages::id...}),
+                  "Each message ID may only be bound once");
+
+public:
+    //! Check whether a message ID has a registered type
+    static constexpr bool contains(uint8_t messageId) {
+        return ((Messages::id == messageId) || ...);
+    }
+    
+    //! Message ID registered for type T
+    template<typename T>
+    static constexpr uint8_t idOf() {
+        static_assert(((std::is_same_v<typename Messages::type, T> ? 1 : 0) + ...) == 1,
+                      "Type must be registered exactly once");
+        uint8_t id = 0;
+        ((std::is_same_v<typename Messages::type, T> ? (id = Messages::id, true) : false), ...);
+        return id;
+    }
+    
+    //! Serialize and frame a registered type under its bound message ID
+    template<typename T>
+    static std::vector<uint8_t> createPacket(const T& data) {
+        return serialflex::createPacket(idOf<T>(), data);
+    }
+    
+    //! Decode a payload as the type bound to messageId and pass it to handler.
+    //! The payload is read in place; handler must be callable with every registered type.
+    template<typename Handler>
+    static DispatchResult dispatch(uint8_t messageId, ByteSpan payload, Handler&& handler) {
+        using H = std::remove_reference_t<Handler>;
+        Thunk<H> thunk = jumpTable<H>[messageId];
+        if (thunk == nullptr) {
+            return DispatchResult::UnknownMessage;
+        }
+        return thunk(payload, handler);
+    }
+    
+    //! Dispatch a packet produced by deframePacket or PacketReceiver
+    template<typename Handler>
+    static DispatchResult dispatch(const DeframedPacket& packet, Handler&& handler) {
+        if (!packet.valid()) {
+            return DispatchResult::InvalidPacket;
+        }
+        return dispatch(packet.messageId, ByteSpan(packet.payload), std::forward<Handler>(handler));
+    }
+
+private:
+    template<typename H>
+    using Thunk = DispatchResult (*)(ByteSpan, H&);
+    
+    template<typename M, typename H>
+    static DispatchResult decodeAndInvoke(ByteSpan payload, H& handler) {
+        using T = typename M::type;
+        static_assert(std::is_invocable_v<H&, T&&>, "Handler must accept every registered message type");
+        
+        ByteReader reader(payload);
+        std::optional<T> value;
+        try {
+            value.emplace(deserialize<T>(reader));
+        } catch (const DeserializationError&) {
+            return DispatchResult::DecodeError;
+        }
+        
+        handler(std::move(*value));
+        return DispatchResult::Handled;
+    }
+    
+    template<typename H>
+    static constexpr std::array<Thunk<H>, 256> makeJumpTable() {
+        std::array<Thunk<H>, 256> table{};
+        ((table[Messages::id] = &decodeAndInvoke<Messages, H>), ...);
+        return table;
+    }
+    
+    template<typename H>
+    static constexpr std::array<Thunk<H>, 256> jumpTable = makeJumpTable<H>();
+};
+
+//! --------------------------------
+//! FRAGMENTATION
+//! --------------------------------
+
+//! Splits payloads that do not fit one frame into sequenced fragments.
+//! Every fragment is an ordinary frame on a dedicated carrier message ID whose
+//! payload is [MSG_ID][TRANSFER_ID][TOTAL_LENGTH u32][OFFSET u32][DATA...].
+class Fragmenter {
+public:
+    static constexpr size_t HEADER_SIZE = 10;
+    
+    //! carrierId: message ID used for fragment frames
+    //! mtu: largest frame payload the receiving side accepts (header included)
+    Fragmenter(uint8_t carrierId, size_t mtu = PacketFramer::PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE)
+        : carrierId_(carrierId), maxChunk_(0), nextTransferId_(0) {
+        if (mtu <= HEADER_SIZE || mtu > PacketFramer::MAX_PAYLOAD_SIZE) {
+            throw std::invalid_argument("Fragment MTU out of range");
+        }
+        maxChunk_ = mtu - HEADER_SIZE;
+    }
+    
+    //! Number of fragment frames needed for a payload of the given size
+    size_t fragmentCount(size_t payloadSize) const {
+        return payloadSize == 0 ? 1 : (payloadSize + maxChunk_ - 1) / maxChunk_;
+    }
+    
+    //! Frame payload as fragments, calling sink(const std::vector<uint8_t>&) once per
+    //! fragment frame. Only one fragment frame exists at a time, so large payloads
+    //! are never duplicated in memory.
+    template<typename Sink>
+    void fragment(uint8_t messageId, ByteSpan payload, Sink&& sink) {
+        if (payload.size() > UINT32_MAX) {
+            throw std::length_error("Payload exceeds 32-bit fragment length");
+        }
+        
+        uint8_t header[HEADER_SIZE];
+        header[0] = messageId;
+        header[1] = nextTransferId_++;
+        writeLE32(header + 2, static_cast<uint32_t>(payload.size()));
+        
+        size_t offset = 0;
+        do {
+            size_t chunk = std::min(maxChunk_, payload.size() - offset);
+            writeLE32(header + 6, static_cast<uint32_t>(offset));
+            
+            PacketFramer::framePacketInto(frame_, carrierId_, ByteSpan(header, HEADER_SIZE),
+                                          payload.subspan(offset, chunk));
+            sink(static_cast<const std::vector<uint8_t>&>(frame_));
+            offset += chunk;
+        } while (offset < payload.size());
+    }
+    
+    //! Serialize a value and send it as fragments
+    template<typename T, typename Sink>
+    void fragmentMessage(uint8_t messageId, const T& data, Sink&& sink) {
+        std::vector<uint8_t> serialized = serialize(data);
+        fragment(messageId, ByteSpan(serialized), std::forward<Sink>(sink));
+    }
+
+private:
+    static void writeLE32(uint8_t* out, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+    
+    uint8_t carrierId_;
+    size_t maxChunk_;
+    uint8_t nextTransferId_;
+    std::vector<uint8_t> frame_;
+};
+
+//! Rebuilds fragmented payloads directly into a preallocated destination.
+//! Fragments are expected in order (as a serial link delivers them); a gap
+//! abandons the transfer, so state stays constant-size regardless of message size.
+class Reassembler {
+public:
+    enum class Status : uint8_t {
+        Incomplete, //! Fragment accepted (or duplicate ignored), more data expected
+        Complete,   //! Message fully reassembled and available via message()
+        Rejected    //! Malformed, out-of-order, or oversized fragment; transfer discarded
+    };
+    
+    //! Reassemble into caller-owned memory of the given capacity
+    Reassembler(uint8_t* destination, size_t capacity)
+        : external_(destination), capacity_(capacity) { reset(); }
+    
+    //! Reassemble into an internal buffer allocated once up front
+    explicit Reassembler(size_t capacity)
+        : storage_(capacity), external_(nullptr), capacity_(capacity) { reset(); }
+    
+    //! Feed the payload of a frame received on the fragment carrier ID
+    Status processFragment(ByteSpan fragment) {
+        if (fragment.size() < Fragmenter::HEADER_SIZE) {
+            reset();
+            return Status::Rejected;
+        }
+        
+        uint8_t messageId = fragment[0];
+        uint8_t transferId = fragment[1];
+        uint32_t totalLength = readLE32(fragment.data() + 2);
+        uint32_t offset = readLE32(fragment.data() + 6);
+        ByteSpan data = fragment.subspan(Fragmenter::HEADER_SIZE, fragment.size() - Fragmenter::HEADER_SIZE);
+        
+        if (offset == 0) {
+            //! First fragment always starts a new transfer, abandoning any unfinished one
+            if (totalLength > capacity_) {
+                reset();
+                return Status::Rejected;
+            }
+            active_ = true;
+            complete_ = false;
+            messageId_ = messageId;
+            transferId_ = transferId;
+            totalLength_ = totalLength;
+            received_ = 0;
+        } 
+        else if (!active_ || transferId != transferId_ || messageId != messageId_ ||
+                 totalLength != totalLength_) {
+            reset();
+            return Status::Rejected;
+        }
+        
+        //! Retransmitted fragment we already hold
+        if (offset + data.size() <= received_ && offset < received_) {
+            return Status::Incomplete;
+        }
+        
+        if (offset != received_ || data.size() > totalLength_ - received_) {
+            reset();
+            return Status::Rejected;
+        }
+        
+        if (!data.empty()) {
+            std::memcpy(buffer() + offset, data.data(), data.size());
+        }
+        received_ += static_cast<uint32_t>(data.size());
+        
+        if (received_ == totalLength_) {
+            active_ = false;
+            complete_ = true;
+            return Status::Complete;
+        }
+        return Status::Incomplete;
+    }
+    
+    //! Convenience overload for packets from PacketReceiver/deframePacket
+    Status processFragment(const DeframedPacket& packet) {
+        if (!packet.valid()) {
+            reset();
+            return Status::Rejected;
+        }
+        return processFragment(ByteSpan(packet.payload));
+    }
+    
+    //! Drop any transfer in progress
+    void reset() {
+        active_ = false;
+        complete_ = false;
+        messageId_ = 0;
+        transferId_ = 0;
+        totalLength_ = 0;
+        received_ = 0;
+    }
+    
+    //! Original message ID of the current/last transfer
+    uint8_t messageId() const {
+        return messageId_;
+    }
+    
+    //! Reassembled payload; only meaningful after Status::Complete
+    ByteSpan message() const {
+        return complete_ ? ByteSpan(buffer(), totalLength_) : ByteSpan();
+    }
+    
+    //! Progress of the current transfer
+    size_t received() const { return received_; }
+    size_t totalLength() const { return totalLength_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    static uint32_t readLE32(const uint8_t* in) {
+        return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+               (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+    }
+    
+    uint8_t* buffer() {
+        return external_ != nullptr ? external_ : storage_.data();
+    }
+    
+    const uint8_t* buffer() const {
+        return external_ != nullptr ? external_ : storage_.data();
+    }
+    
+    std::vector<uint8_t> storage_;
+    uint8_t* external_;
+    size_t capacity_;
+    bool active_;
+    bool complete_;
+    uint8_t messageId_;
+    uint8_t transferId_;
+    uint32_t totalLength_;
+    uint32_t received_;
+};
+
+//! --------------------------------
+//! FRAME PREEMPTION
+//! --------------------------------
+
+//! Transmit side of preemptive framing (in the spirit of IEEE 802.3br).
+//! Express frames are inserted into the payload of an in-flight bulk frame as
+//! ESCAPE_BYTE followed by the complete express frame. Regular stuffing never
+//! puts a raw START_BYTE after ESCAPE_BYTE, so the pair is an unambiguous marker;
+//! the bulk frame resumes right after the express END_BYTE.
+//! Express frames themselves are never interrupted.
+class PreemptiveTransmitter {
+public:
+    PreemptiveTransmitter() : bulkPos_(0), expressPos_(0), expressActive_(false) {}
+    
+    //! Queue a framed packet that express traffic may interrupt
+    void queueBulk(std::vector<uint8_t> frame) {
+        bulkQueue_.push_back(std::move(frame));
+    }
+    
+    //! Queue a framed packet that preempts bulk traffic at the next safe point
+    void queueExpress(std::vector<uint8_t> frame) {
+        expressQueue_.push_back(std::move(frame));
+    }
+    
+    //! Fill out with up to capacity bytes of link data; returns the number written.
+    //! Keep chunks small (e.g. the UART FIFO size): express latency is bounded by
+    //! the chunk already handed to the driver plus a few bytes of bulk header/CRC.
+    size_t nextChunk(uint8_t* out, size_t capacity) {
+        size_t written = 0;
+        
+        while (written < capacity) {
+            if (expressActive_) {
+                const std::vector<uint8_t>& frame = expressQueue_.front();
+                size_t count = std::min(frame.size() - expressPos_, capacity - written);
+                std::memcpy(out + written, frame.data() + expressPos_, count);
+                written += count;
+                expressPos_ += count;
+                if (expressPos_ == frame.size()) {
+                    expressQueue_.pop_front();
+                    expressActive_ = false;
+                }
+                continue;
+            }
+            
+            if (!expressQueue_.empty()) {
+                if (bulkQueue_.empty() || bulkPos_ == 0) {
+                    //! Frame boundary: send the express frame as-is
+                    startExpress();
+                    continue;
+                }
+                if (atPreemptionPoint()) {
+                    out[written++] = PacketFramer::ESCAPE_BYTE;
+                    startExpress();
+                    continue;
+                }
+            }
+            
+            if (bulkQueue_.empty()) {
+                break;
+            }
+            
+            //! With express traffic waiting, advance bulk one byte at a time to the next safe point
+            const std::vector<uint8_t>& frame = bulkQueue_.front();
+            size_t count = expressQueue_.empty() ? std::min(frame.size() - bulkPos_, capacity - written) : 1;
+            std::memcpy(out + written, frame.data() + bulkPos_, count);
+            written += count;
+            bulkPos_ += count;
+            if (bulkPos_ == frame.size()) {
+                bulkQueue_.pop_front();
+                bulkPos_ = 0;
+            }
+        }
+        
+        return written;
+    }
+    
+    //! Nothing left to send
+    bool idle() const {
+        return bulkQueue_.empty() && expressQueue_.empty();
+    }
+    
+    size_t pendingBulk() const { return bulkQueue_.size(); }
+    size_t pendingExpress() const { return expressQueue_.size(); }
+
+private:
+    void startExpress() {
+        expressActive_ = true;
+        expressPos_ = 0;
+    }
+    
+    //! The next bulk byte is a payload byte and does not complete an escape pair
+    bool atPreemptionPoint() const {
+        const std::vector<uint8_t>& frame = bulkQueue_.front();
+        return bulkPos_ >= 4 && bulkPos_ + 3 < frame.size() &&
+               (bulkPos_ == 4 || frame[bulkPos_ - 1] != PacketFramer::ESCAPE_BYTE);
+    }
+    
+    std::deque<std::vector<uint8_t>> bulkQueue_;
+    std::deque<std::vector<uint8_t>> expressQueue_;
+    size_t bulkPos_;
+    size_t expressPos_;
+    bool expressActive_;
+};
+
+//! Receive side of preemptive framing: tracks the interrupted bulk frame and a
+//! nested express frame with two ordinary receivers, delivering whichever
+//! completes. Also accepts plain (non-preempted) streams.
+class PreemptiveReceiver {
+public:
+    explicit PreemptiveReceiver(size_t maxPayloadSize = PacketFramer::PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE)
+        : bulk_(maxPayloadSize), express_(maxPayloadSize), pendingEscape_(false), inExpress_(false) {}
+    
+    //! Process a single byte, returns true if a complete packet (bulk or express) was received
+    bool processByte(uint8_t byte, DeframedPacket& outPacket) {
+        if (inExpress_) {
+            if (express_.processByte(byte, outPacket)) {
+                inExpress_ = false;
+                return true;
+            }
+            return false;
+        }
+        
+        if (pendingEscape_) {
+            pendingEscape_ = false;
+            if (byte == PacketFramer::START_BYTE) {
+                //! ESCAPE + START: an express frame interrupts the bulk payload
+                inExpress_ = true;
+                express_.processByte(byte, outPacket);
+                return false;
+            }
+            bulk_.processByte(PacketFramer::ESCAPE_BYTE, outPacket);
+            return bulk_.processByte(byte, outPacket);
+        }
+        
+        if (byte == PacketFramer::ESCAPE_BYTE && bulk_.inPayload()) {
+            //! Hold back until we know whether this escapes a byte or marks preemption
+            pendingEscape_ = true;
+            return false;
+        }
+        
+        return bulk_.processByte(byte, outPacket);
+    }
+    
+    //! True while an express frame is being received inside a bulk frame
+    bool preempted() const {
+        return inExpress_;
+    }
+
+private:
+    PacketFramer::PacketReceiver bulk_;
+    PacketFramer::PacketReceiver express_;
+    bool pendingEscape_;
+    bool inExpress_;
+};
+
+//! --------------------------------
+//! CUT-THROUGH FORWARDING
+//! --------------------------------
+
+//! Relays frames between links by message ID without unstuffing or copying payloads.
+//! Once the 4-byte header is in, each frame is routed by router(messageId) -> output
+//! port (or DROP), and the still-stuffed bytes go out unchanged as they arrive. The
+//! CRC can be checked on the fly for accounting; a frame with a bad CRC has already
+//! left, but it leaves byte-identical, so the next receiver rejects it too.
+template<typename Router>
+class CutThroughForwarder {
+public:
+    static constexpr int DROP = -1;
+    
+    struct Stats {
+        uint64_t forwarded = 0;     //! Frames relayed to an output port
+        uint64_t dropped = 0;       //! Frames the router discarded
+        uint64_t crcErrors = 0;     //! Relayed frames whose CRC did not verify
+        uint64_t framingErrors = 0; //! Frames cut short by an unexpected marker
+    };
+    
+    explicit CutThroughForwarder(Router router, bool verifyCrc = true)
+        : router_(std::move(router)), verifyCrc_(verifyCrc), state_(State::Idle), escapeNext_(false),
+          port_(DROP), remaining_(0), crc_(0), receivedCrc_(0), header_{} {}
+    
+    //! Consume a chunk of incoming link bytes. sink(int port, ByteSpan bytes) receives
+    //! spans pointing into data (or into the saved header), never copies of the payload.
+    template<typename Sink>
+    void processChunk(ByteSpan data, Sink&& sink) {
+        size_t runStart = 0; //! First byte of the current frame not yet relayed
+        
+        for (size_t i = 0; i < data.size(); i++) {
+            uint8_t byte = data[i];
+            
+            switch (state_) {
+            case State::Idle:
+                if (byte == PacketFramer::START_BYTE) {
+                    beginFrame();
+                }
+                runStart = i + 1;
+                break;
+                
+            case State::MessageId:
+            case State::LengthLow:
+                header_[state_ == State::MessageId ? 1 : 2] = byte;
+                crc_ = CRC::updateCRC16(crc_, byte);
+                state_ = state_ == State::MessageId ? State::LengthLow : State::LengthHigh;
+                runStart = i + 1;
+                break;
+                
+            case State::LengthHigh:
+                header_[3] = byte;
+                crc_ = CRC::updateCRC16(crc_, byte);
+                remaining_ = static_cast<uint16_t>(header_[2] | (static_cast<uint16_t>(byte) << 8));
+                
+                //! Routing decision: start transmitting immediately
+                port_ = router_(header_[1]);
+                if (port_ != DROP) {
+                    sink(port_, ByteSpan(header_, sizeof(header_)));
+                }
+                state_ = remaining_ > 0 ? State::Payload : State::CrcLow;
+                runStart = i + 1;
+                break;
+                
+            case State::Payload:
+                if (byte == PacketFramer::START_BYTE) {
+                    //! Truncated frame: pass on what we have and resynchronize
+                    relay(sink, data, runStart, i);
+                    stats_.framingErrors++;
+                    beginFrame();
+                    runStart = i + 1;
+                    break;
+                }
+                crc_ = CRC::updateCRC16(crc_, byte);
+                
+                if (escapeNext_) {
+                    escapeNext_ = false;
+                    remaining_--;
+                } 
+                else if (byte == PacketFramer::ESCAPE_BYTE) {
+                    escapeNext_ = true;
+                } 
+                else if (byte == PacketFramer::END_BYTE) {
+                    relay(sink, data, runStart, i + 1);
+                    stats_.framingErrors++;
+                    state_ = State::Idle;
+                    runStart = i + 1;
+                    break;
+                } 
+                else {
+                    remaining_--;
+                }
+                
+                if (remaining_ == 0) {
+                    state_ = State::CrcLow;
+                }
+                break;
+                
+            case State::CrcLow:
+                receivedCrc_ = byte;
+                state_ = State::CrcHigh;
+                break;
+                
+            case State::CrcHigh:
+                receivedCrc_ |= static_cast<uint16_t>(byte) << 8;
+                state_ = State::End;
+                break;
+                
+            case State::End:
+                state_ = State::Idle;
+                if (byte == PacketFramer::END_BYTE) {
+                    relay(sink, data, runStart, i + 1);
+                    finishFrame();
+                } 
+                else if (byte == PacketFramer::START_BYTE) {
+                    relay(sink, data, runStart, i);
+                    stats_.framingErrors++;
+                    beginFrame();
+                } 
+                else {
+                    relay(sink, data, runStart, i + 1);
+                    stats_.framingErrors++;
+                }
+                runStart = i + 1;
+                break;
+            }
+        }
+        
+        //! Frame still in flight: relay the part received so far
+        if (state_ == State::Payload || state_ == State::CrcLow || 
+            state_ == State::CrcHigh || state_ == State::End) {
+            relay(sink, data, runStart, data.size());
+        }
+    }
+    
+    const Stats& stats() const {
+        return stats_;
+    }
+
+private:
+    enum class State : uint8_t {
+        Idle,
+        MessageId,
+        LengthLow,
+        LengthHigh,
+        Payload,
+        CrcLow,
+        CrcHigh,
+        End
+    };
+    
+    void beginFrame() {
+        header_[0] = PacketFramer::START_BYTE;
+        state_ = State::MessageId;
+        escapeNext_ = false;
+        crc_ = 0xFFFF;
+    }
+    
+    void finishFrame() {
+        if (port_ == DROP) {
+            stats_.dropped++;
+            return;
+        }
+        stats_.forwarded++;
+        if (verifyCrc_ && receivedCrc_ != crc_) {
+            stats_.crcErrors++;
+        }
+    }
+    
+    template<typename Sink>
+    void relay(Sink& sink, ByteSpan data, size_t begin, size_t end) {
+        if (port_ != DROP && end > begin) {
+            sink(port_, data.subspan(begin, end - begin));
+        }
+    }
+    
+    Router router_;
+    bool verifyCrc_;
+    State state_;
+    bool escapeNext_;
+    int port_;
+    uint16_t remaining_;
+    uint16_t crc_;
+    uint16_t receivedCrc_;
+    uint8_t header_[4];
+    Stats stats_;
+};
+
+//! --------------------------------
+//! FRAME TEMPLATES
+//! --------------------------------
+
+//! A message framed once and then patched in place for each send, for periodic
+//! frames (heartbeats, status) that only differ in a few fields.
+//! Patches rewrite the affected wire bytes and fold the change into the CRC via
+//! CRC linearity. Only when a byte moves into or out of the escaped set does the
+//! wire layout shift; then the frame is restuffed from the patched range onward.
+class FrameTemplate {
+public:
+    FrameTemplate(uint8_t messageId, ByteSpan payload)
+        : messageId_(messageId), payload_(payload.begin(), payload.end()) {
+        PacketFramer::framePacketInto(frame_, messageId_, ByteSpan(payload_));
+        
+        //! Record where each payload byte starts on the wire
+        wirePos_.resize(payload_.size());
+        size_t pos = 4;
+        for (size_t i = 0; i < payload_.size(); i++) {
+            wirePos_[i] = static_cast<uint32_t>(pos);
+            pos += PacketFramer::needsEscape(payload_[i]) ? 2 : 1;
+        }
+    }
+    
+    //! Build a template from any serializable value
+    template<typename T>
+    static FrameTemplate fromMessage(uint8_t messageId, const T& data) {
+        std::vector<uint8_t> serialized = serialize(data);
+        return FrameTemplate(messageId, ByteSpan(serialized));
+    }
+    
+    //! Overwrite payload bytes starting at offset
+    void patch(size_t offset, ByteSpan bytes) {
+        if (offset > payload_.size() || bytes.size() > payload_.size() - offset) {
+            throw std::out_of_range("Patch exceeds payload");
+        }
+        
+        //! Slow path: escape state changes shift everything behind the first such byte
+        for (size_t i = 0; i < bytes.size(); i++) {
+            if (PacketFramer::needsEscape(payload_[offset + i]) != PacketFramer::needsEscape(bytes[i])) {
+                std::memcpy(payload_.data() + offset, bytes.data(), bytes.size());
+                restuffFrom(offset);
+                return;
+            }
+        }
+        
+        size_t crcPos = frame_.size() - 3;
+        uint16_t delta = 0;
+        for (size_t i = 0; i < bytes.size(); i++) {
+            uint8_t oldByte = payload_[offset + i];
+            uint8_t newByte = bytes[i];
+            if (oldByte == newByte) {
+                continue;
+            }
+            payload_[offset + i] = newByte;
+            
+            //! Escaped bytes keep their ESCAPE_BYTE; only the XORed byte after it changes
+            bool escaped = PacketFramer::needsEscape(newByte);
+            size_t pos = wirePos_[offset + i] + (escaped ? 1 : 0);
+            uint8_t wireByte = escaped ? static_cast<uint8_t>(newByte ^ 0x20) : newByte;
+            
+            delta ^= CRC::crc16ByteContribution(frame_[pos] ^ wireByte, crcPos - 1 - pos);
+            frame_[pos] = wireByte;
+        }
+        
+        writeCrc(readCrc() ^ delta);
+    }
+    
+    //! Overwrite a trivially copyable field at the given payload offset
+    template<typename T>
+    void patchField(size_t offset, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable fields can be patched");
+        patch(offset, ByteSpan(reinterpret_cast<const uint8_t*>(&value), sizeof(T)));
+    }
+    
+    //! Current framed bytes, ready to send
+    const std::vector<uint8_t>& frame() const {
+        return frame_;
+    }
+    
+    //! Current (unstuffed) payload
+    ByteSpan payload() const {
+        return ByteSpan(payload_);
+    }
+    
+    uint8_t messageId() const {
+        return messageId_;
+    }
+
+private:
+    void restuffFrom(size_t index) {
+        frame_.resize(wirePos_[index]);
+        for (size_t i = index; i < payload_.size(); i++) {
+            wirePos_[i] = static_cast<uint32_t>(frame_.size());
+            uint8_t byte = payload_[i];
+            if (PacketFramer::needsEscape(byte)) {
+                frame_.push_back(PacketFramer::ESCAPE_BYTE);
+                frame_.push_back(byte ^ 0x20);
+            } else {
+                frame_.push_back(byte);
+            }
+        }
+        
+        frame_.push_back(0);
+        frame_.push_back(0);
+        frame_.push_back(PacketFramer::END_BYTE);
+        writeCrc(CRC::calculateCRC16(frame_.data() + 1, frame_.size() - 4));
+    }
+    
+    uint16_t readCrc() const {
+        size_t crcPos = frame_.size() - 3;
+        return static_cast<uint16_t>(frame_[crcPos] | (frame_[crcPos + 1] << 8));
+    }
+    
+    void writeCrc(uint16_t crc) {
+        size_t crcPos = frame_.size() - 3;
+        frame_[crcPos] = static_cast<uint8_t>(crc & 0xFF);
+        frame_[crcPos + 1] = static_cast<uint8_t>((crc >> 8) & 0xFF);
+    }
+    
+    uint8_t messageId_;
+    std::vector<uint8_t> payload_;
+    std::vector<uint32_t> wirePos_;
+    std::vector<uint8_t> frame_;
+};
+
+//! --------------------------------
+//! CONSTANT FRAMES
+//! --------------------------------
+
+//! Constant-expression counterparts of serialize()/framePacket() for fixed messages.
+//! Values are encoded little-endian, which matches serialize() on little-endian
+//! targets (x86, ARM Cortex-M, RISC-V). Supported fields: integers, enums, bools,
+//! string literals (encoded like std::string), std::array of those, and floating
+//! point where std::bit_cast is available.
+namespace detail {
+    template<typename T>
+    constexpr std::array<uint8_t, sizeof(T)> constBytes(T value) {
+        if constexpr (std::is_enum_v<T>) {
+            return constBytes(static_cast<std::underlying_type_t<T>>(value));
+        } 
+        else if constexpr (std::is_same_v<T, bool>) {
+            return {static_cast<uint8_t>(value ? 1 : 0)};
+        } 
+#if defined(__cpp_lib_bit_cast)
+        else if constexpr (std::is_floating_point_v<T>) {
+            using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+            return constBytes(std::bit_cast<Bits>(value));
+        } 
+#endif
+        else {
+            static_assert(std::is_integral_v<T>, "Constant serialization supports integers, enums and bools");
+            using U = std::make_unsigned_t<T>;
+            U bits = static_cast<U>(value);
+            std::array<uint8_t, sizeof(T)> bytes{};
+            for (size_t i = 0; i < sizeof(T); i++) {
+                bytes[i] = static_cast<uint8_t>(bits >> (8 * i));
+            }
+            return bytes;
+        }
+    }
+    
+    template<size_t N>
+    constexpr void appendConst(uint8_t* out, size_t& pos, const std::array<uint8_t, N>& part) {
+        for (size_t i = 0; i < N; i++) {
+            out[pos++] = part[i];
+        }
+    }
+    
+    template<size_t... Ns>
+    constexpr std::array<uint8_t, (Ns + ... + 0)> concatConst(const std::array<uint8_t, Ns>&... parts) {
+        std::array<uint8_t, (Ns + ... + 0)> out{};
+        size_t pos = 0;
+        (appendConst(out.data(), pos, parts), ...);
+        return out;
+    }
+    
+    template<typename T>
+    constexpr auto constEncode(const T& value) {
+        return constBytes(value);
+    }
+    
+    //! String literal: 32-bit length followed by the characters (no terminator)
+    template<size_t N>
+    constexpr auto constEncode(const char (&text)[N]) {
+        std::array<uint8_t, N - 1> chars{};
+        for (size_t i = 0; i + 1 < N; i++) {
+            chars[i] = static_cast<uint8_t>(text[i]);
+        }
+        return concatConst(constBytes(static_cast<uint32_t>(N - 1)), chars);
+    }
+    
+    //! Fixed arrays are trivially copyable, so serialize() writes their elements back to back
+    template<typename T, size_t N>
+    constexpr auto constEncode(const std::array<T, N>& values) {
+        std::array<uint8_t, sizeof(T) * N> out{};
+        size_t pos = 0;
+        for (size_t i = 0; i < N; i++) {
+            appendConst(out.data(), pos, constBytes(values[i]));
+        }
+        return out;
+    }
+}
+
+//! Serialize a fixed sequence of fields into a std::array at compile time
+template<typename... Fields>
+constexpr auto serializeConst(const Fields&... fields) {
+    return detail::concatConst(detail::constEncode(fields)...);
+}
+
+//! Exact framed size of a constant payload (stuffing included)
+template<size_t N>
+constexpr size_t framedSizeConst(const std::array<uint8_t, N>& payload) {
+    size_t size = N + 7;
+    for (size_t i = 0; i < N; i++) {
+        if (PacketFramer::needsEscape(payload[i])) {
+            size++;
+        }
+    }
+    return size;
+}
+
+//! Frame a constant payload into an array of exactly FrameSize bytes.
+//! FrameSize must equal framedSizeConst(payload); makeConstFrame computes it for you.
+template<size_t FrameSize, size_t N>
+constexpr std::array<uint8_t, FrameSize> framePacketConst(uint8_t messageId, const std::array<uint8_t, N>& payload) {
+    static_assert(N <= PacketFramer::MAX_PAYLOAD_SIZE, "Payload exceeds 16-bit length field");
+    if (framedSizeConst(payload) != FrameSize) {
+        throw std::length_error("Frame size does not match payload");
+    }
+    
+    std::array<uint8_t, FrameSize> frame{};
+    size_t pos = 0;
+    frame[pos++] = PacketFramer::START_BYTE;
+    frame[pos++] = messageId;
+    frame[pos++] = static_cast<uint8_t>(N & 0xFF);
+    frame[pos++] = static_cast<uint8_t>((N >> 8) & 0xFF);
+    
+    for (size_t i = 0; i < N; i++) {
+        if (PacketFramer::needsEscape(payload[i])) {
+            frame[pos++] = PacketFramer::ESCAPE_BYTE;
+            frame[pos++] = static_cast<uint8_t>(payload[i] ^ 0x20);
+        } else {
+            frame[pos++] = payload[i];
+        }
+    }
+    
+    uint16_t crc = CRC::calculateCRC16(frame.data() + 1, pos - 1);
+    frame[pos++] = static_cast<uint8_t>(crc & 0xFF);
+    frame[pos++] = static_cast<uint8_t>((crc >> 8) & 0xFF);
+    frame[pos++] = PacketFramer::END_BYTE;
+    return frame;
+}
+
+//! Frame a namespace-scope constexpr payload: 
+//!   constexpr auto RESET_PAYLOAD = serializeConst(...);
+//!   constexpr auto RESET_FRAME = makeConstFrame<0x02, RESET_PAYLOAD>();
+template<uint8_t MessageId, const auto& Payload>
+constexpr auto makeConstFrame() {
+    return framePacketConst<framedSizeConst(Payload)>(MessageId, Payload);
+}
+
+//! Compare received bytes against a constant frame
+template<size_t N>
+bool matchesFrame(ByteSpan data, const std::array<uint8_t, N>& frame) {
+    return data.size() == N && std::memcmp(data.data(), frame.data(), N) == 0;
+}
+
+//! --------------------------------
+//! MULTI-STREAM RECEIVE
+//! --------------------------------
+
+//! Raw bytes received on one stream of a MultiStreamReceiver
+struct StreamChunk {
+    uint32_t stream = 0;
+    ByteSpan data;
+};
+
+//! Frame delivered by MultiStreamReceiver; payload is only valid during the callback
+struct StreamPacket {
+    uint32_t stream = 0;
+    uint8_t messageId = 0;
+    FrameStatus status = FrameStatus::TooSmall;
+    ByteSpan payload;
+    
+    bool valid() const {
+        return status == FrameStatus::Ok;
+    }
+    
+    const char* errorReason() const {
+        return toString(status);
+    }
+};
+
+//! Frame receiver for thousands of independent streams (device connections).
+//! Per-stream state lives in parallel arrays (STATE_BYTES_PER_STREAM bytes per stream)
+//! instead of one heap object per stream, and is loaded into locals once per chunk.
+//! Payload buffers come from a shared pool and are held only by frames in flight,
+//! so memory grows with concurrently incomplete frames, not with the stream count.
+//! Frames are accepted and rejected exactly as PacketReceiver does.
+class MultiStreamReceiver {
+public:
+    //! state + messageId + length + received + crc + receivedCrc + buffer index
+    static constexpr size_t STATE_BYTES_PER_STREAM = 14;
+    
+    MultiStreamReceiver(size_t streamCount, size_t maxPayloadSize = PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE)
+        : maxPayloadSize_(maxPayloadSize), state_(streamCount, State::Idle), messageId_(streamCount, 0),
+          length_(streamCount, 0), received_(streamCount, 0), crc_(streamCount, 0),
+          receivedCrc_(streamCount, 0), buffer_(streamCount, NO_BUFFER) {
+        if (streamCount == 0 || streamCount > UINT32_MAX) {
+            throw std::invalid_argument("Stream count out of range");
+        }
+        if (maxPayloadSize > PacketFramer::MAX_PAYLOAD_SIZE) {
+            throw std::invalid_argument("Payload limit exceeds 16-bit length field");
+        }
+    }
+    
+    //! Feed bytes received on one stream, calling callback(const StreamPacket&)
+    //! for every completed or rejected frame. The callback must not call back into
+    //! the receiver.
+    template<typename Callback>
+    void processChunk(uint32_t stream, ByteSpan data, Callback&& callback) {
+        checkStream(stream);
+        
+        Cursor c = load(stream);
+        const uint8_t* bytes = data.data();
+        size_t size = data.size();
+        size_t i = 0;
+        
+        while (i < size) {
+            switch (c.state) {
+            case State::Idle: {
+                //! Skip line noise in one go
+                const void* start = std::memchr(bytes + i, PacketFramer::START_BYTE, size - i);
+                if (start == nullptr) {
+                    i = size;
+                    break;
+                }
+                i = static_cast<size_t>(static_cast<const uint8_t*>(start) - bytes) + 1;
+                beginFrame(c);
+                break;
+            }
+                
+            case State::MessageId:
+                c.messageId = bytes[i];
+                c.crc = CRC::updateCRC16(c.crc, bytes[i++]);
+                c.state = State::LengthLow;
+                break;
+                
+            case State::LengthLow:
+                c.length = bytes[i];
+                c.crc = CRC::updateCRC16(c.crc, bytes[i++]);
+                c.state = State::LengthHigh;
+                break;
+                
+            case State::LengthHigh:
+                c.length |= static_cast<uint16_t>(bytes[i]) << 8;
+                c.crc = CRC::updateCRC16(c.crc, bytes[i++]);
+                if (c.length > maxPayloadSize_) {
+                    c.state = State::Idle;
+                    emit(stream, c, FrameStatus::BufferOverflow, callback);
+                } else if (c.length == 0) {
+                    c.state = State::CrcLow;
+                } else {
+                    c.buffer = acquireBuffer();
+                    c.state = State::Payload;
+                }
+                break;
+                
+            case State::Payload: {
+                //! Copy the run of plain bytes up to the next marker or the end of the payload
+                size_t limit = std::min(size, i + (c.length - c.received));
+                size_t run = i;
+                while (run < limit && !PacketFramer::needsEscape(bytes[run])) {
+                    run++;
+                }
+                if (run > i) {
+                    std::memcpy(bufferData(c.buffer) + c.received, bytes + i, run - i);
+                    c.crc = CRC::updateCRC16(c.crc, bytes + i, run - i);
+                    c.received = static_cast<uint16_t>(c.received + (run - i));
+                    i = run;
+                    if (c.received == c.length) {
+                        c.state = State::CrcLow;
+                    }
+                    break;
+                }
+                
+                uint8_t byte = bytes[i++];
+                if (byte == PacketFramer::START_BYTE) {
+                    //! A raw start byte never appears inside a payload: resynchronize
+                    emit(stream, c, FrameStatus::UnexpectedStart, callback);
+                    beginFrame(c);
+                    break;
+                }
+                c.crc = CRC::updateCRC16(c.crc, byte);
+                if (byte == PacketFramer::END_BYTE) {
+                    c.state = State::Idle;
+                    emit(stream, c, FrameStatus::LengthMismatch, callback);
+                } else {
+                    c.state = State::PayloadEscaped;
+                }
+                break;
+            }
+                
+            case State::PayloadEscaped: {
+                uint8_t byte = bytes[i++];
+                if (byte == PacketFramer::START_BYTE) {
+                    emit(stream, c, FrameStatus::UnexpectedStart, callback);
+                    beginFrame(c);
+                    break;
+                }
+                c.crc = CRC::updateCRC16(c.crc, byte);
+                bufferData(c.buffer)[c.received++] = byte ^ 0x20; //! Unescape
+                c.state = c.received == c.length ? State::CrcLow : State::Payload;
+                break;
+            }
+                
+            case State::CrcLow:
+                c.receivedCrc = bytes[i++];
+                c.state = State::CrcHigh;
+                break;
+                
+            case State::CrcHigh:
+                c.receivedCrc |= static_cast<uint16_t>(bytes[i++]) << 8;
+                c.state = State::End;
+                break;
+                
+            case State::End: {
+                uint8_t byte = bytes[i++];
+                c.state = State::Idle;
+                if (byte != PacketFramer::END_BYTE) {
+                    emit(stream, c, FrameStatus::InvalidMarkers, callback);
+                    if (byte == PacketFramer::START_BYTE) {
+                        beginFrame(c);
+                    }
+                } else {
+                    emit(stream, c, c.receivedCrc == c.crc ? FrameStatus::Ok : FrameStatus::CrcMismatch, callback);
+                }
+                break;
+            }
+            }
+        }
+        
+        store(stream, c);
+    }
+    
+    //! Feed a batch of chunks in order. Chunks for the same stream must appear in
+    //! arrival order; streams may be interleaved freely.
+    template<typename Callback>
+    void processBatch(Span<const StreamChunk> batch, Callback&& callback) {
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (i + 1 < batch.size()) {
+                prefetch(batch[i + 1].stream);
+            }
+            processChunk(batch[i].stream, batch[i].data, callback);
+        }
+    }
+    
+    //! Drop any partial frame on a stream (e.g. after a reconnect)
+    void reset(uint32_t stream) {
+        checkStream(stream);
+        Cursor c = load(stream);
+        releaseBuffer(c);
+        c.state = State::Idle;
+        store(stream, c);
+    }
+    
+    //! True while a frame is partially received on the stream
+    bool inFrame(uint32_t stream) const {
+        checkStream(stream);
+        return state_[stream] != State::Idle;
+    }
+    
+    size_t streamCount() const {
+        return state_.size();
+    }
+    
+    size_t maxPayloadSize() const {
+        return maxPayloadSize_;
+    }
+    
+    //! Pooled payload buffers allocated so far, and how many are held by frames in flight
+    size_t bufferCount() const {
+        return maxPayloadSize_ == 0 ? 0 : pool_.size() / maxPayloadSize_;
+    }
+    
+    size_t buffersInUse() const {
+        return bufferCount() - freeBuffers_.size();
+    }
+
+private:
+    static constexpr uint32_t NO_BUFFER = UINT32_MAX;
+    
+    enum class State : uint8_t {
+        Idle,
+        MessageId,
+        LengthLow,
+        LengthHigh,
+        Payload,
+        PayloadEscaped,
+        CrcLow,
+        CrcHigh,
+        End
+    };
+    
+    //! Working copy of one stream's state, kept in registers while a chunk is processed
+    struct Cursor {
+        State state;
+        uint8_t messageId;
+        uint16_t length;
+        uint16_t received;
+        uint16_t crc;
+        uint16_t receivedCrc;
+        uint32_t buffer;
+    };
+    
+    Cursor load(uint32_t stream) const {
+        return Cursor{state_[stream], messageId_[stream], length_[stream], received_[stream],
+                      crc_[stream], receivedCrc_[stream], buffer_[stream]};
+    }
+    
+    void store(uint32_t stream, const Cursor& c) {
+        state_[stream] = c.state;
+        messageId_[stream] = c.messageId;
+        length_[stream] = c.length;
+        received_[stream] = c.received;
+        crc_[stream] = c.crc;
+        receivedCrc_[stream] = c.receivedCrc;
+        buffer_[stream] = c.buffer;
+    }
+    
+    void checkStream(uint32_t stream) const {
+        if (stream >= state_.size()) {
+            throw std::out_of_range("Stream index out of range");
+        }
+    }
+    
+    void prefetch(uint32_t stream) const {
+#if defined(__GNUC__)
+        if (stream < state_.size()) {
+            __builtin_prefetch(&state_[stream]);
+            __builtin_prefetch(&crc_[stream]);
+        }
+#else
+        (void)stream;
+#endif
+    }
+    
+    static void beginFrame(Cursor& c) {
+        c.state = State::MessageId;
+        c.length = 0;
+        c.received = 0;
+        c.crc = 0xFFFF;
+    }
+    
+    //! Deliver a finished frame and return its buffer to the pool
+    template<typename Callback>
+    void emit(uint32_t stream, Cursor& c, FrameStatus status, Callback& callback) {
+        StreamPacket packet;
+        packet.stream = stream;
+        packet.messageId = c.messageId;
+        packet.status = status;
+        if (status == FrameStatus::Ok && c.buffer != NO_BUFFER) {
+            packet.payload = ByteSpan(bufferData(c.buffer), c.received);
+        }
+        callback(static_cast<const StreamPacket&>(packet));
+        releaseBuffer(c);
+    }
+    
+    uint32_t acquireBuffer() {
+        if (!freeBuffers_.empty()) {
+            uint32_t index = freeBuffers_.back();
+            freeBuffers_.pop_back();
+            return index;
+        }
+        uint32_t index = static_cast<uint32_t>(bufferCount());
+        pool_.resize(pool_.size() + maxPayloadSize_);
+        return index;
+    }
+    
+    void releaseBuffer(Cursor& c) {
+        if (c.buffer != NO_BUFFER) {
+            freeBuffers_.push_back(c.buffer);
+            c.buffer = NO_BUFFER;
+        }
+    }
+    
+    uint8_t* bufferData(uint32_t index) {
+        return pool_.data() + static_cast<size_t>(index) * maxPayloadSize_;
+    }
+    
+    size_t maxPayloadSize_;
+    
+    //! Struct-of-arrays stream state, indexed by stream
+    std::vector<State> state_;
+    std::vector<uint8_t> messageId_;
+    std::vector<uint16_t> length_;
+    std::vector<uint16_t> received_;
+    std::vector<uint16_t> crc_;
+    std::vector<uint16_t> receivedCrc_;
+    std::vector<uint32_t> buffer_;
+    
+    //! Payload buffers for frames in flight, maxPayloadSize_ bytes each
+    std::vector<uint8_t> pool_;
+    std::vector<uint32_t> freeBuffers_;
+};
+
 } //! namespace serialflex
\ No newline at end of file
@@ -0,0 +1,384 @@
+#pragma once
+
+#include "serialflex.hpp"
+#include "serialflex_queue.hpp"
+#include <chrono>
+#include <cmath>
+
+namespace serialflex {
+
+//! --------------------------------
+//! RELIABLE DELIVERY (SELECTIVE-REPEAT ARQ)
+//! --------------------------------
+
+//! Settings shared by both ends of an ArqLink; they must agree on the IDs and window
+struct ArqConfig {
+    using Duration = std::chrono::microseconds;
+
+    size_t window = 64;                     //! Frames in flight, rounded up to a power of two
+    uint8_t dataId = 0xF0;                  //! Message ID carrying sequenced data
+    uint8_t ackId = 0xF1;                   //! Message ID carrying acknowledgements
+    Duration initialRto = std::chrono::milliseconds(200);
+    Duration minRto = std::chrono::milliseconds(5);
+    Duration maxRto = std::chrono::seconds(4);
+    size_t ackEvery = 2;                    //! Acknowledge after this many in-order frames...
+    Duration ackDelay = std::chrono::milliseconds(2); //! ...or once the oldest unacknowledged one is this old
+    uint8_t fastRetransmitThreshold = 3;    //! ACKs reporting a gap before it is resent early
+};
+
+//! Reliable, in-order message delivery over a lossy link, on top of PacketFramer.
+//!
+//! Data frames use config.dataId and carry [seq:16][messageId:8][payload]; ACK frames
+//! use config.ackId and carry [next expected seq:16][bitmap]. Bit i of the bitmap
+//! marks seq = next + 1 + i as received, so the sender resends only what is missing.
+//! Up to `window` frames stay in flight, so the link stays busy during a round trip.
+//!
+//! Retransmission follows TCP practice:
+//!  - The timeout is srtt + 4 * rttvar (RFC 6298). Samples come only from frames
+//!    sent once (Karn), and the timeout doubles after each expiry.
+//!  - A frame that fastRetransmitThreshold ACKs report missing, behind later frames
+//!    that did arrive, is resent without waiting for the timer.
+//!
+//! The link keeps no clock and runs no thread. Every call takes `now`, and
+//! nextDeadline() says when tick() must run next, so the same code runs in real
+//! time or in a simulated one. sink(ByteSpan frame) writes one frame to the wire.
+//! Refused or lost writes are simply retransmitted later.
+template<typename Sink>
+class ArqLink {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Duration = ArqConfig::Duration;
+
+    //! Largest user payload: the frame limit minus the sequence and ID bytes
+    static constexpr size_t MAX_PAYLOAD_SIZE = PacketFramer::MAX_PAYLOAD_SIZE - 3;
+
+    struct Stats {
+        uint64_t sent = 0;                 //! New data frames
+        uint64_t retransmitted = 0;        //! Resends after a timeout
+        uint64_t fastRetransmitted = 0;    //! Resends triggered by selective ACKs
+        uint64_t delivered = 0;            //! Messages handed to onMessage, in order
+        uint64_t duplicates = 0;           //! Data frames received more than once
+        uint64_t acksSent = 0;
+        uint64_t acksReceived = 0;
+    };
+
+    explicit ArqLink(Sink sink, ArqConfig config = ArqConfig())
+        : sink_(std::move(sink)), config_(config),
+          window_(detail::roundUpToPowerOfTwo(std::max<size_t>(config.window, 1))),
+          sendSlots_(window_), rto_(config.initialRto), receiveSlots_(window_) {
+        if (window_ > MAX_WINDOW) {
+            throw std::invalid_argument("ARQ window exceeds half the sequence space");
+        }
+        if (config.dataId == config.ackId) {
+            throw std::invalid_argument("ARQ data and ACK IDs must differ");
+        }
+    }
+
+    //! Queue a message for reliable delivery and transmit it. Returns false (and
+    //! sends nothing) while the window is full; retry after ACKs arrive.
+    bool send(uint8_t messageId, ByteSpan payload, TimePoint now) {
+        if (payload.size() > MAX_PAYLOAD_SIZE) {
+            throw std::length_error("Payload exceeds ARQ frame capacity");
+        }
+        if (!canSend()) {
+            return false;
+        }
+
+        SendSlot& slot = sendSlots_[nextSeq_ & (window_ - 1)];
+        uint8_t header[3] = {static_cast<uint8_t>(nextSeq_ & 0xFF), static_cast<uint8_t>(nextSeq_ >> 8), messageId};
+        PacketFramer::framePacketInto(slot.frame, config_.dataId, ByteSpan(header, sizeof(header)), payload);
+        slot.acked = false;
+        slot.transmissions = 0;
+        slot.missingReports = 0;
+        nextSeq_++;
+
+        transmit(slot, now);
+        stats_.sent++;
+        return true;
+    }
+
+    //! Serialize and send a message
+    template<typename T>
+    bool sendMessage(uint8_t messageId, const T& data, TimePoint now) {
+        return send(messageId, ByteSpan(serialize(data)), now);
+    }
+
+    //! Feed a frame from the wire. Data frames are acknowledged and their messages
+    //! passed to onMessage(uint8_t messageId, ByteSpan payload) in send order, with
+    //! no gaps or duplicates; ACKs release and, where needed, resend frames.
+    //! Returns false for frames that are not ARQ traffic (or failed validation).
+    template<typename OnMessage>
+    bool receive(const DeframedPacket& packet, TimePoint now, OnMessage&& onMessage) {
+        if (!packet.valid()) {
+            return false; //! Corrupted frames count as lost
+        }
+        ByteSpan payload(packet.payload);
+        if (packet.messageId == config_.dataId && payload.size() >= 3) {
+            receiveData(payload, now, onMessage);
+            return true;
+        }
+        if (packet.messageId == config_.ackId && payload.size() >= 2) {
+            receiveAck(payload, now);
+            return true;
+        }
+        return false;
+    }
+
+    //! Run timers: resend frames whose timeout expired and flush a delayed ACK
+    void tick(TimePoint now) {
+        if (ackPending_ > 0 && now >= ackDeadline_) {
+            sendAck();
+        }
+
+        bool expired = false;
+        for (uint16_t seq = base_; seq != nextSeq_; seq++) {
+            SendSlot& slot = sendSlots_[seq & (window_ - 1)];
+            if (!slot.acked && now - slot.sentAt >= rto_) {
+                if (!expired) {
+                    //! Back off once per expiry, not once per frame
+                    rto_ = std::min<Duration>(rto_ * 2, config_.maxRto);
+                    expired = true;
+                }
+                transmit(slot, now);
+                stats_.retransmitted++;
+            }
+        }
+    }
+
+    //! When tick() next has work to do; TimePoint::max() when nothing is pending
+    TimePoint nextDeadline() const {
+        TimePoint deadline = ackPending_ > 0 ? ackDeadline_ : TimePoint::max();
+        for (uint16_t seq = base_; seq != nextSeq_; seq++) {
+            const SendSlot& slot = sendSlots_[seq & (window_ - 1)];
+            if (!slot.acked) {
+                deadline = std::min(deadline, slot.sentAt + rto_);
+            }
+        }
+        return deadline;
+    }
+
+    bool canSend() const {
+        return inFlight() < window_;
+    }
+
+    //! Frames sent and not yet cumulatively acknowledged
+    size_t inFlight() const {
+        return static_cast<uint16_t>(nextSeq_ - base_);
+    }
+
+    size_t window() const {
+        return window_;
+    }
+
+    //! Current retransmission timeout
+    Duration rto() const {
+        return rto_;
+    }
+
+    //! Smoothed round-trip time; zero until the first sample
+    Duration srtt() const {
+        return Duration(static_cast<Duration::rep>(srtt_));
+    }
+
+    const Stats& stats() const {
+        return stats_;
+    }
+
+private:
+    //! Selective repeat needs sender and receiver windows within half the 16-bit space
+    static constexpr size_t MAX_WINDOW = 32768;
+
+    struct SendSlot {
+        std::vector<uint8_t> frame;  //! Framed once, resent as is
+        TimePoint sentAt;
+        uint64_t order = 0;          //! Position among all transmissions, resends included
+        uint32_t transmissions = 0;
+        uint8_t missingReports = 0;
+        bool acked = false;
+    };
+
+    struct ReceiveSlot {
+        bool present = false;
+        uint8_t messageId = 0;
+        std::vector<uint8_t> payload;
+    };
+
+    //! Signed distance from b to a in sequence space
+    static int16_t seqDiff(uint16_t a, uint16_t b) {
+        return static_cast<int16_t>(static_cast<uint16_t>(a - b));
+    }
+
+    void transmit(SendSlot& slot, TimePoint now) {
+        slot.sentAt = now;
+        slot.order = ++transmitOrder_;
+        slot.transmissions++;
+        slot.missingReports = 0;
+        sink_(ByteSpan(slot.frame));
+    }
+
+    template<typename OnMessage>
+    void receiveData(ByteSpan payload, TimePoint now, OnMessage& onMessage) {
+        uint16_t seq = static_cast<uint16_t>(payload[0] | (payload[1] << 8));
+        uint8_t messageId = payload[2];
+        ByteSpan body = payload.subspan(3, payload.size() - 3);
+        int16_t offset = seqDiff(seq, expected_);
+
+        if (offset < 0 || static_cast<size_t>(offset) >= window_) {
+            //! Already delivered (our ACK was lost) or outside the window: re-acknowledge at once
+            stats_.duplicates++;
+            sendAck();
+            return;
+        }
+
+        if (offset > 0) {
+            //! Out of order: hold it and report the gap immediately
+            ReceiveSlot& slot = receiveSlots_[seq & (window_ - 1)];
+            if (slot.present) {
+                stats_.duplicates++;
+            } else {
+                held_++;
+                slot.present = true;
+                slot.messageId = messageId;
+                slot.payload.assign(body.begin(), body.end());
+            }
+            sendAck();
+            return;
+        }
+
+        //! In order: deliver straight from the frame, then drain what was held behind it
+        expected_++;
+        stats_.delivered++;
+        onMessage(messageId, body);
+        for (ReceiveSlot* slot = &receiveSlots_[expected_ & (window_ - 1)]; slot->present;
+             slot = &receiveSlots_[expected_ & (window_ - 1)]) {
+            slot->present = false;
+            held_--;
+            expected_++;
+            stats_.delivered++;
+            onMessage(slot->messageId, ByteSpan(slot->payload));
+        }
+
+        if (ackPending_++ == 0) {
+            ackDeadline_ = now + config_.ackDelay;
+        }
+        //! While frames are held beyond a gap the sender is waiting on our ACK
+        if (ackPending_ >= config_.ackEvery || held_ > 0) {
+            sendAck();
+        }
+    }
+
+    void sendAck() {
+        //! Bitmap covers held frames up to the last one present
+        size_t bits = 0;
+        for (size_t i = 1; held_ > 0 && i < window_; i++) {
+            if (receiveSlots_[(expected_ + i) & (window_ - 1)].present) {
+                bits = i;
+            }
+        }
+
+        ackFrame_.assign({static_cast<uint8_t>(expected_ & 0xFF), static_cast<uint8_t>(expected_ >> 8)});
+        ackFrame_.resize(2 + (bits + 7) / 8, 0);
+        for (size_t i = 1; i <= bits; i++) {
+            if (receiveSlots_[(expected_ + i) & (window_ - 1)].present) {
+                ackFrame_[2 + (i - 1) / 8] |= static_cast<uint8_t>(1u << ((i - 1) % 8));
+            }
+        }
+
+        PacketFramer::framePacketInto(ackScratch_, config_.ackId, ByteSpan(ackFrame_));
+        sink_(ByteSpan(ackScratch_));
+        ackPending_ = 0;
+        stats_.acksSent++;
+    }
+
+    void receiveAck(ByteSpan payload, TimePoint now) {
+        stats_.acksReceived++;
+        uint16_t next = static_cast<uint16_t>(payload[0] | (payload[1] << 8));
+        if (seqDiff(next, base_) < 0 || seqDiff(next, nextSeq_) > 0) {
+            return; //! Stale or bogus
+        }
+
+        //! Cumulative part: everything before next arrived
+        for (; base_ != next; base_++) {
+            acknowledge(sendSlots_[base_ & (window_ - 1)], now);
+        }
+
+        //! Selective part: frames held by the receiver past the gap
+        uint16_t highestHeld = next;
+        size_t bits = (payload.size() - 2) * 8;
+        for (size_t i = 0; i < bits; i++) {
+            if ((payload[2 + i / 8] >> (i % 8)) & 1) {
+                uint16_t seq = static_cast<uint16_t>(next + 1 + i);
+                if (seqDiff(seq, nextSeq_) >= 0) {
+                    break;
+                }
+                acknowledge(sendSlots_[seq & (window_ - 1)], now);
+                highestHeld = seq;
+            }
+        }
+
+        //! A frame still missing after ones transmitted later arrived was most likely lost,
+        //! not delayed. Comparing transmission order keeps a resend from being resent
+        //! again until frames sent after it come back.
+        for (uint16_t seq = base_; seq != highestHeld; seq++) {
+            SendSlot& slot = sendSlots_[seq & (window_ - 1)];
+            if (!slot.acked && slot.order < deliveredOrder_ &&
+                ++slot.missingReports >= config_.fastRetransmitThreshold) {
+                transmit(slot, now);
+                stats_.fastRetransmitted++;
+            }
+        }
+    }
+
+    void acknowledge(SendSlot& slot, TimePoint now) {
+        deliveredOrder_ = std::max(deliveredOrder_, slot.order);
+        if (slot.acked) {
+            return;
+        }
+        slot.acked = true;
+        if (slot.transmissions == 1) {
+            updateRtt(std::chrono::duration_cast<Duration>(now - slot.sentAt));
+        }
+    }
+
+    //! RFC 6298 estimator; integer microseconds are precise enough here
+    void updateRtt(Duration sample) {
+        double r = static_cast<double>(sample.count());
+        if (srtt_ == 0) {
+            srtt_ = r;
+            rttvar_ = r / 2;
+        } else {
+            rttvar_ = 0.75 * rttvar_ + 0.25 * std::abs(srtt_ - r);
+            srtt_ = 0.875 * srtt_ + 0.125 * r;
+        }
+        Duration rto(static_cast<Duration::rep>(srtt_ + std::max(4 * rttvar_, 1000.0)));
+        rto_ = std::clamp(rto, config_.minRto, config_.maxRto);
+    }
+
+    Sink sink_;
+    ArqConfig config_;
+    size_t window_;
+
+    //! Sender: [base_, nextSeq_) in flight
+    std::vector<SendSlot> sendSlots_;
+    uint16_t base_ = 0;
+    uint16_t nextSeq_ = 0;
+    Duration rto_;
+    uint64_t transmitOrder_ = 0;
+    uint64_t deliveredOrder_ = 0;   //! Latest transmission known to have arrived
+    double srtt_ = 0;
+    double rttvar_ = 0;
+
+    //! Receiver: expected_ is the next sequence number to deliver
+    std::vector<ReceiveSlot> receiveSlots_;
+    uint16_t expected_ = 0;
+    size_t held_ = 0;               //! Out-of-order frames waiting in receiveSlots_
+    size_t ackPending_ = 0;
+    TimePoint ackDeadline_;
+    std::vector<uint8_t> ackFrame_;
+    std::vector<uint8_t> ackScratch_;
+
+    Stats stats_;
+};
+
+} //! namespace serialflex
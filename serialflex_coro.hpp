@@ -0,0 +1,461 @@
+#pragma once
+
+#include "serialflex.hpp"
+
+#if !defined(__cpp_impl_coroutine)
+#error "serialflex_coro.hpp needs C++20 coroutines (-std=c++20)"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace serialflex {
+
+//! --------------------------------
+//! COROUTINES
+//! --------------------------------
+
+//! Thrown from co_await on an AsyncLink that was closed while (or before) waiting
+class LinkClosedError : public std::runtime_error {
+public:
+    LinkClosedError() : std::runtime_error("Link closed") {}
+};
+
+template<typename T = void>
+class Task;
+
+namespace detail {
+    struct TaskPromiseBase {
+        //! At the end, hand control back to whoever awaited the task (if anyone)
+        struct FinalAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+            
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                std::coroutine_handle<> continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            
+            void await_resume() const noexcept {}
+        };
+        
+        //! Tasks start eagerly, so the first co_await runs before the caller continues
+        std::suspend_never initial_suspend() const noexcept {
+            return {};
+        }
+        
+        FinalAwaiter final_suspend() const noexcept {
+            return {};
+        }
+        
+        void unhandled_exception() {
+            exception = std::current_exception();
+        }
+        
+        void rethrowIfFailed() const {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+        
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+    };
+    
+    template<typename T>
+    struct TaskPromise : TaskPromiseBase {
+        Task<T> get_return_object();
+        
+        template<typename U>
+        void return_value(U&& value) {
+            result.emplace(std::forward<U>(value));
+        }
+        
+        T take() {
+            rethrowIfFailed();
+            return std::move(*result);
+        }
+        
+        std::optional<T> result;
+    };
+    
+    template<>
+    struct TaskPromise<void> : TaskPromiseBase {
+        Task<void> get_return_object();
+        
+        void return_void() const noexcept {}
+        
+        void take() const {
+            rethrowIfFailed();
+        }
+    };
+    
+    //! Node of an AsyncLink wait list. Lives inside an awaiter, which lives in the
+    //! suspended coroutine's frame, so waiting allocates nothing.
+    struct LinkWaiter {
+        LinkWaiter* prev = nullptr;
+        LinkWaiter* next = nullptr;
+        bool linked = false;
+        std::coroutine_handle<> handle;
+    };
+    
+    //! Intrusive FIFO of waiters
+    class WaitList {
+    public:
+        void pushBack(LinkWaiter& waiter) {
+            waiter.prev = tail_;
+            waiter.next = nullptr;
+            if (tail_ != nullptr) {
+                tail_->next = &waiter;
+            } else {
+                head_ = &waiter;
+            }
+            tail_ = &waiter;
+            waiter.linked = true;
+            size_++;
+        }
+        
+        void remove(LinkWaiter& waiter) {
+            if (!waiter.linked) {
+                return;
+            }
+            (waiter.prev != nullptr ? waiter.prev->next : head_) = waiter.next;
+            (waiter.next != nullptr ? waiter.next->prev : tail_) = waiter.prev;
+            waiter.prev = waiter.next = nullptr;
+            waiter.linked = false;
+            size_--;
+        }
+        
+        LinkWaiter* front() const {
+            return head_;
+        }
+        
+        bool empty() const {
+            return head_ == nullptr;
+        }
+        
+        size_t size() const {
+            return size_;
+        }
+    
+    private:
+        LinkWaiter* head_ = nullptr;
+        LinkWaiter* tail_ = nullptr;
+        size_t size_ = 0;
+    };
+}
+
+//! Coroutine return type. Starts running immediately and can be co_awaited from
+//! another Task; the awaiting coroutine resumes inline when this one finishes.
+//! Destroying a Task that is still suspended destroys its frame and withdraws it
+//! from every AsyncLink it was waiting on.
+template<typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+    
+    bool done() const {
+        return handle_ && handle_.done();
+    }
+    
+    //! Result of a finished task; rethrows whatever escaped the coroutine
+    T result() {
+        if (!done()) {
+            throw std::logic_error("Task has not finished");
+        }
+        return handle_.promise().take();
+    }
+    
+    bool await_ready() const noexcept {
+        return handle_.done();
+    }
+    
+    void await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+    }
+    
+    T await_resume() {
+        return handle_.promise().take();
+    }
+
+private:
+    friend promise_type;
+    
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+    template<typename T>
+    Task<T> TaskPromise<T>::get_return_object() {
+        return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+    }
+    
+    inline Task<void> TaskPromise<void>::get_return_object() {
+        return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+    }
+}
+
+//! Coroutine face of one link: co_await receive<T>() for the next message of a
+//! registered type, co_await send(message) to frame and write one.
+//!
+//! There is no executor thread. Feed every frame the link receives to deliver()
+//! (typically from a transport's onPacket callback); the oldest coroutine waiting
+//! for that message type is resumed inline, on the caller's stack, before
+//! deliver() returns. Awaiters are linked into the link's wait lists from inside
+//! the coroutine frame, so apart from the frame itself nothing is allocated.
+//!
+//! sink(ByteSpan frame) -> bool writes one framed packet, returning false when the
+//! transport cannot take it yet. A send that is refused suspends its coroutine
+//! until writable() is called, and later sends queue behind it in order.
+//!
+//! All calls must come from the thread that runs the event loop.
+template<typename Registry, typename Sink>
+class AsyncLink {
+public:
+    template<typename T>
+    class ReceiveAwaiter;
+    
+    template<typename T>
+    class SendAwaiter;
+    
+    explicit AsyncLink(Sink sink) : sink_(std::move(sink)), closed_(false) {}
+    
+    //! Waiters point back at the link, so it stays where it was built
+    AsyncLink(const AsyncLink&) = delete;
+    AsyncLink& operator=(const AsyncLink&) = delete;
+    
+    ~AsyncLink() {
+        close();
+    }
+    
+    //! Awaitable resolving to the next T that arrives after the coroutine suspends
+    template<typename T>
+    ReceiveAwaiter<T> receive() {
+        return ReceiveAwaiter<T>(*this);
+    }
+    
+    //! Awaitable that frames and writes message under its registered ID. The message
+    //! is read again on retry, so co_await the result directly.
+    template<typename T>
+    SendAwaiter<T> send(const T& message) {
+        return SendAwaiter<T>(*this, message);
+    }
+    
+    //! Offer a received frame to the waiting coroutines. Returns Handled when one
+    //! was resumed, UnknownMessage when none is waiting for the ID (dispatch it
+    //! elsewhere), DecodeError when the payload does not decode (the waiter keeps
+    //! waiting) and InvalidPacket for frames that failed validation.
+    DispatchResult deliver(const DeframedPacket& packet) {
+        if (!packet.valid()) {
+            return DispatchResult::InvalidPacket;
+        }
+        
+        for (detail::LinkWaiter* node = receivers_.front(); node != nullptr; node = node->next) {
+            auto& waiter = static_cast<ReceiveWaiter&>(*node);
+            if (waiter.messageId != packet.messageId) {
+                continue;
+            }
+            if (!waiter.decode(waiter, ByteSpan(packet.payload))) {
+                return DispatchResult::DecodeError;
+            }
+            receivers_.remove(waiter);
+            waiter.handle.resume();
+            return DispatchResult::Handled;
+        }
+        return DispatchResult::UnknownMessage;
+    }
+    
+    //! Retry sends refused by the sink, oldest first, resuming each one that goes out
+    void writable() {
+        while (!senders_.empty()) {
+            auto& waiter = static_cast<SendWaiter&>(*senders_.front());
+            if (!waiter.write(waiter, *this)) {
+                return;
+            }
+            senders_.remove(waiter);
+            waiter.handle.resume();
+        }
+    }
+    
+    //! Fail every waiting coroutine with LinkClosedError; later awaits fail at once
+    void close() {
+        closed_ = true;
+        resumeAll(receivers_);
+        resumeAll(senders_);
+    }
+    
+    bool closed() const {
+        return closed_;
+    }
+    
+    size_t waitingReceivers() const {
+        return receivers_.size();
+    }
+    
+    size_t waitingSenders() const {
+        return senders_.size();
+    }
+
+private:
+    struct ReceiveWaiter : detail::LinkWaiter {
+        uint8_t messageId = 0;
+        bool (*decode)(ReceiveWaiter&, ByteSpan) = nullptr;
+    };
+    
+    struct SendWaiter : detail::LinkWaiter {
+        bool sent = false;
+        bool (*write)(SendWaiter&, AsyncLink&) = nullptr;
+    };
+    
+    //! Resumed waiters find no value (or sent == false) and throw LinkClosedError
+    static void resumeAll(detail::WaitList& list) {
+        while (!list.empty()) {
+            detail::LinkWaiter& waiter = *list.front();
+            list.remove(waiter);
+            waiter.handle.resume();
+        }
+    }
+    
+    Sink sink_;
+    bool closed_;
+    detail::WaitList receivers_;
+    detail::WaitList senders_;
+    std::vector<uint8_t> payloadScratch_;
+    std::vector<uint8_t> frameScratch_;
+
+public:
+    template<typename T>
+    class ReceiveAwaiter {
+    public:
+        explicit ReceiveAwaiter(AsyncLink& link) : link_(&link) {
+            waiter_.messageId = Registry::template idOf<T>();
+            waiter_.decode = &decode;
+        }
+        
+        ReceiveAwaiter(const ReceiveAwaiter&) = delete;
+        ReceiveAwaiter& operator=(const ReceiveAwaiter&) = delete;
+        
+        ~ReceiveAwaiter() {
+            link_->receivers_.remove(waiter_);
+        }
+        
+        bool await_ready() const noexcept {
+            return link_->closed_;
+        }
+        
+        void await_suspend(std::coroutine_handle<> handle) {
+            waiter_.handle = handle;
+            link_->receivers_.pushBack(waiter_);
+        }
+        
+        T await_resume() {
+            if (!waiter_.value) {
+                throw LinkClosedError();
+            }
+            return std::move(*waiter_.value);
+        }
+    
+    private:
+        struct Waiter : ReceiveWaiter {
+            std::optional<T> value;
+        };
+        
+        static bool decode(ReceiveWaiter& base, ByteSpan payload) {
+            auto& waiter = static_cast<Waiter&>(base);
+            try {
+                waiter.value.emplace(deserialize<T>(payload));
+            } catch (const DeserializationError&) {
+                return false;
+            }
+            return true;
+        }
+        
+        AsyncLink* link_;
+        Waiter waiter_;
+    };
+    
+    template<typename T>
+    class SendAwaiter {
+    public:
+        SendAwaiter(AsyncLink& link, const T& message) : link_(&link) {
+            waiter_.message = &message;
+            waiter_.write = &write;
+        }
+        
+        SendAwaiter(const SendAwaiter&) = delete;
+        SendAwaiter& operator=(const SendAwaiter&) = delete;
+        
+        ~SendAwaiter() {
+            link_->senders_.remove(waiter_);
+        }
+        
+        //! Writes right away unless the link is closed or earlier sends are still queued
+        bool await_ready() {
+            if (link_->closed_) {
+                return true;
+            }
+            return link_->senders_.empty() && write(waiter_, *link_);
+        }
+        
+        void await_suspend(std::coroutine_handle<> handle) {
+            waiter_.handle = handle;
+            link_->senders_.pushBack(waiter_);
+        }
+        
+        void await_resume() const {
+            if (!waiter_.sent) {
+                throw LinkClosedError();
+            }
+        }
+    
+    private:
+        struct Waiter : SendWaiter {
+            const T* message = nullptr;
+        };
+        
+        static bool write(SendWaiter& base, AsyncLink& link) {
+            auto& waiter = static_cast<Waiter&>(base);
+            serializeInto(link.payloadScratch_, *waiter.message);
+            PacketFramer::framePacketInto(link.frameScratch_, Registry::template idOf<T>(),
+                                          ByteSpan(link.payloadScratch_));
+            waiter.sent = link.sink_(ByteSpan(link.frameScratch_));
+            return waiter.sent;
+        }
+        
+        AsyncLink* link_;
+        Waiter waiter_;
+    };
+};
+
+//! Build an AsyncLink with the sink type deduced:
+//!   auto link = makeAsyncLink<Registry>([&](ByteSpan frame) { return transport.send(id, frame); });
+template<typename Registry, typename Sink>
+AsyncLink<Registry, Sink> makeAsyncLink(Sink sink) {
+    return AsyncLink<Registry, Sink>(std::move(sink));
+}
+
+} //! namespace serialflex
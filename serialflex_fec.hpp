@@ -0,0 +1,368 @@
+#pragma once
+
+#include "serialflex.hpp"
+
+namespace serialflex {
+
+//! --------------------------------
+//! FORWARD ERROR CORRECTION (REED-SOLOMON)
+//! --------------------------------
+
+namespace detail {
+
+//! GF(2^8) with the primitive polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11D).
+//! exp is doubled so the sum of two logarithms indexes it without a modulo.
+struct GaloisTables {
+    uint8_t exp[512] = {};
+    uint8_t log[256] = {};
+
+    constexpr GaloisTables() {
+        unsigned value = 1;
+        for (unsigned i = 0; i < 255; i++) {
+            exp[i] = static_cast<uint8_t>(value);
+            log[value] = static_cast<uint8_t>(i);
+            value <<= 1;
+            if (value & 0x100) {
+                value ^= 0x11D;
+            }
+        }
+        for (unsigned i = 255; i < 512; i++) {
+            exp[i] = exp[i - 255];
+        }
+    }
+};
+
+inline constexpr GaloisTables GF256{};
+
+inline uint8_t gfMul(uint8_t a, uint8_t b) {
+    return (a == 0 || b == 0) ? 0 : GF256.exp[GF256.log[a] + GF256.log[b]];
+}
+
+inline uint8_t gfDiv(uint8_t a, uint8_t b) {
+    return a == 0 ? 0 : GF256.exp[GF256.log[a] + 255 - GF256.log[b]];
+}
+
+inline uint8_t gfInverse(uint8_t a) {
+    return GF256.exp[255 - GF256.log[a]];
+}
+
+//! Evaluate a polynomial stored lowest degree first
+inline uint8_t gfEvaluate(const uint8_t* poly, size_t terms, uint8_t x) {
+    uint8_t result = 0;
+    for (size_t i = terms; i-- > 0;) {
+        result = static_cast<uint8_t>(gfMul(result, x) ^ poly[i]);
+    }
+    return result;
+}
+
+} //! namespace detail
+
+//! Systematic Reed-Solomon code over GF(256) with a configurable number of parity
+//! symbols. A codeword is at most 255 bytes. It corrects up to paritySymbols / 2
+//! corrupted bytes anywhere in the codeword, parity included.
+class ReedSolomon {
+public:
+    static constexpr size_t MAX_CODEWORD_SIZE = 255;
+
+    explicit ReedSolomon(size_t paritySymbols) : paritySymbols_(paritySymbols) {
+        if (paritySymbols < 2 || paritySymbols > 128) {
+            throw std::invalid_argument("Reed-Solomon parity symbols must be between 2 and 128");
+        }
+
+        //! g(x) = (x - a^0)(x - a^1)...(x - a^(n-1)), highest degree first
+        uint8_t generator[MAX_PARITY + 1] = {1};
+        for (size_t i = 0; i < paritySymbols; i++) {
+            uint8_t root = detail::GF256.exp[i];
+            for (size_t j = i + 1; j > 0; j--) {
+                generator[j] = static_cast<uint8_t>(generator[j] ^ detail::gfMul(generator[j - 1], root));
+            }
+        }
+        //! Encoding multiplies the generator by one feedback byte per data byte; tabulate
+        //! every such product (the leading coefficient is 1 and drops out of the division)
+        products_.resize(256 * paritySymbols);
+        for (unsigned feedback = 0; feedback < 256; feedback++) {
+            for (size_t j = 0; j < paritySymbols; j++) {
+                products_[feedback * paritySymbols + j] = detail::gfMul(static_cast<uint8_t>(feedback), generator[j + 1]);
+            }
+        }
+    }
+
+    size_t paritySymbols() const {
+        return paritySymbols_;
+    }
+
+    //! Largest data block per codeword
+    size_t maxDataSize() const {
+        return MAX_CODEWORD_SIZE - paritySymbols_;
+    }
+
+    //! Compute the parity of `count` data bytes read `stride` apart, and write it
+    //! `stride` apart, so interleaved blocks are encoded without gathering them
+    void encode(const uint8_t* data, size_t count, size_t stride, uint8_t* parity) const {
+        uint8_t remainder[MAX_PARITY] = {};
+        size_t last = paritySymbols_ - 1;
+        for (size_t i = 0; i < count; i++) {
+            uint8_t feedback = static_cast<uint8_t>(data[i * stride] ^ remainder[0]);
+            const uint8_t* product = products_.data() + feedback * paritySymbols_;
+            //! Shift the remainder by one and add the product in the same pass
+            for (size_t j = 0; j < last; j++) {
+                remainder[j] = static_cast<uint8_t>(remainder[j + 1] ^ product[j]);
+            }
+            remainder[last] = product[last];
+        }
+        for (size_t j = 0; j < paritySymbols_; j++) {
+            parity[j * stride] = remainder[j];
+        }
+    }
+
+    //! Correct a codeword of `size` bytes (data followed by parity) in place.
+    //! Returns the number of corrected bytes, or -1 when there are too many errors.
+    int decode(uint8_t* codeword, size_t size) const {
+        size_t n = paritySymbols_;
+
+        //! Syndromes: the codeword evaluated at each generator root
+        uint8_t syndromes[MAX_PARITY];
+        bool clean = true;
+        for (size_t j = 0; j < n; j++) {
+            uint8_t root = detail::GF256.exp[j];
+            uint8_t value = 0;
+            for (size_t i = 0; i < size; i++) {
+                value = static_cast<uint8_t>(detail::gfMul(value, root) ^ codeword[i]);
+            }
+            syndromes[j] = value;
+            clean = clean && value == 0;
+        }
+        if (clean) {
+            return 0;
+        }
+
+        //! Berlekamp-Massey: shortest LFSR (error locator) generating the syndromes
+        uint8_t locator[MAX_PARITY + 1] = {1};
+        uint8_t previous[MAX_PARITY + 1] = {1};
+        size_t errors = 0;
+        size_t shift = 1;
+        uint8_t previousDiscrepancy = 1;
+        for (size_t k = 0; k < n; k++) {
+            uint8_t discrepancy = syndromes[k];
+            for (size_t i = 1; i <= errors; i++) {
+                discrepancy ^= detail::gfMul(locator[i], syndromes[k - i]);
+            }
+            if (discrepancy == 0) {
+                shift++;
+                continue;
+            }
+            uint8_t scale = detail::gfDiv(discrepancy, previousDiscrepancy);
+            if (2 * errors <= k) {
+                uint8_t saved[MAX_PARITY + 1];
+                std::memcpy(saved, locator, n + 1);
+                for (size_t i = 0; i + shift <= n; i++) {
+                    locator[i + shift] ^= detail::gfMul(scale, previous[i]);
+                }
+                errors = k + 1 - errors;
+                std::memcpy(previous, saved, n + 1);
+                previousDiscrepancy = discrepancy;
+                shift = 1;
+            } else {
+                for (size_t i = 0; i + shift <= n; i++) {
+                    locator[i + shift] ^= detail::gfMul(scale, previous[i]);
+                }
+                shift++;
+            }
+        }
+        if (2 * errors > n) {
+            return -1;
+        }
+
+        //! Error evaluator: syndromes times locator, mod x^n
+        uint8_t evaluator[MAX_PARITY] = {};
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j <= std::min(i, errors); j++) {
+                evaluator[i] ^= detail::gfMul(syndromes[i - j], locator[j]);
+            }
+        }
+
+        //! Chien search over the codeword positions, Forney for each magnitude.
+        //! Byte i holds the coefficient of x^(size - 1 - i); its locator is a^(size - 1 - i).
+        size_t found = 0;
+        for (size_t i = 0; i < size; i++) {
+            uint8_t location = detail::GF256.exp[size - 1 - i];
+            uint8_t inverse = detail::gfInverse(location);
+            if (detail::gfEvaluate(locator, errors + 1, inverse) != 0) {
+                continue;
+            }
+            //! Formal derivative: only odd powers survive in characteristic 2
+            uint8_t derivative = 0;
+            uint8_t inverseSquared = detail::gfMul(inverse, inverse);
+            uint8_t power = 1;
+            for (size_t j = 1; j <= errors; j += 2) {
+                derivative ^= detail::gfMul(locator[j], power);
+                power = detail::gfMul(power, inverseSquared);
+            }
+            if (derivative == 0) {
+                return -1;
+            }
+            uint8_t magnitude = detail::gfMul(location,
+                detail::gfDiv(detail::gfEvaluate(evaluator, n, inverse), derivative));
+            codeword[i] ^= magnitude;
+            found++;
+        }
+
+        //! Fewer roots than the locator degree means the errors exceeded what it can place
+        return found == errors ? static_cast<int>(found) : -1;
+    }
+
+private:
+    static constexpr size_t MAX_PARITY = 128;
+
+    size_t paritySymbols_;
+    std::vector<uint8_t> products_; //! [feedback][j]: feedback times generator coefficient j + 1
+};
+
+enum class FecStatus : uint8_t {
+    Clean,          //! CRC passed; parity stripped
+    Corrected,      //! CRC failed and every block decoded; payload repaired but not re-verified
+    Uncorrectable,  //! More errors than the parity can fix
+    Invalid         //! Not an FEC frame, or dropped by the receiver before repair was possible
+};
+
+struct FecResult {
+    FecStatus status = FecStatus::Invalid;
+    size_t correctedBytes = 0;
+
+    bool valid() const {
+        return status == FecStatus::Clean || status == FecStatus::Corrected;
+    }
+};
+
+//! Frames with Reed-Solomon parity appended to the payload, so a receiver can
+//! repair frames that fail the CRC check instead of asking for a retransmission.
+//!
+//! The message ID and payload are split byte by byte across ceil((1 + size) / k)
+//! codewords, with k = 255 - paritySymbols, and the parity of each codeword is
+//! interleaved the same way after the payload. A burst of b corrupted bytes thus
+//! costs every codeword at most ceil(b / blocks) bytes. The result goes out as an
+//! ordinary frame: the header, stuffing and CRC are unchanged, and the length field
+//! counts the parity.
+//!
+//! Only byte errors inside the frame can be repaired. A corrupted header, marker
+//! or escape byte still breaks the frame apart, and PacketReceiver drops it. Both
+//! ends must agree on paritySymbols. Receivers must call setKeepCorruptPayloads(true),
+//! or deframePacket(frame, true), so that damaged payloads reach decode().
+//!
+//! A Corrected payload is not checked again: the frame's CRC covers the damaged
+//! bytes, not the repair. A codeword hit by more than paritySymbols / 2 errors is
+//! usually reported Uncorrectable, but can decode to a different valid codeword.
+//! Protocols that cannot tolerate that should carry their own check in the payload.
+class FecCodec {
+public:
+    explicit FecCodec(size_t paritySymbols = 16) : code_(paritySymbols) {}
+
+    //! Number of interleaved codewords protecting a payload
+    size_t blockCount(size_t payloadSize) const {
+        return (payloadSize + 1 + code_.maxDataSize() - 1) / code_.maxDataSize();
+    }
+
+    //! Payload size on the wire, parity included
+    size_t encodedSize(size_t payloadSize) const {
+        return payloadSize + blockCount(payloadSize) * code_.paritySymbols();
+    }
+
+    //! Frame a payload with parity into out, reusing its capacity
+    void framePacketInto(std::vector<uint8_t>& out, uint8_t messageId, ByteSpan payload) {
+        size_t blocks = blockCount(payload.size());
+        size_t parityBytes = blocks * code_.paritySymbols();
+
+        //! Codeword input is [ID][payload]; gather it once so each block is a strided view
+        protectedBytes_.resize(1 + payload.size() + parityBytes);
+        protectedBytes_[0] = messageId;
+        std::copy(payload.begin(), payload.end(), protectedBytes_.begin() + 1);
+        uint8_t* parity = protectedBytes_.data() + 1 + payload.size();
+        for (size_t block = 0; block < blocks; block++) {
+            code_.encode(protectedBytes_.data() + block, dataCount(block, blocks, 1 + payload.size()),
+                         blocks, parity + block);
+        }
+        PacketFramer::framePacketInto(out, messageId, ByteSpan(protectedBytes_.data() + 1, protectedBytes_.size() - 1));
+    }
+
+    std::vector<uint8_t> framePacket(uint8_t messageId, ByteSpan payload) {
+        std::vector<uint8_t> out;
+        framePacketInto(out, messageId, payload);
+        return out;
+    }
+
+    //! Strip the parity from a received packet, repairing it first if its CRC failed.
+    //! On success the packet holds the original ID and payload with status Ok.
+    FecResult decode(DeframedPacket& packet) {
+        FecResult result;
+        bool damaged = packet.status == FrameStatus::CrcMismatch;
+        size_t payloadSize = 0;
+        if ((!packet.valid() && !damaged) || !payloadSizeFor(packet.payload.size(), payloadSize)) {
+            return result;
+        }
+        size_t blocks = blockCount(payloadSize);
+
+        if (damaged) {
+            size_t dataSize = 1 + payloadSize;
+            protectedBytes_.resize(dataSize + blocks * code_.paritySymbols());
+            protectedBytes_[0] = packet.messageId;
+            std::copy(packet.payload.begin(), packet.payload.end(), protectedBytes_.begin() + 1);
+
+            uint8_t codeword[ReedSolomon::MAX_CODEWORD_SIZE];
+            for (size_t block = 0; block < blocks; block++) {
+                size_t count = dataCount(block, blocks, dataSize);
+                size_t size = count + code_.paritySymbols();
+                for (size_t i = 0; i < count; i++) {
+                    codeword[i] = protectedBytes_[block + i * blocks];
+                }
+                for (size_t i = 0; i < code_.paritySymbols(); i++) {
+                    codeword[count + i] = protectedBytes_[dataSize + block + i * blocks];
+                }
+
+                int corrected = code_.decode(codeword, size);
+                if (corrected < 0) {
+                    result.status = FecStatus::Uncorrectable;
+                    return result;
+                }
+                for (size_t i = 0; corrected > 0 && i < count; i++) {
+                    protectedBytes_[block + i * blocks] = codeword[i];
+                }
+                result.correctedBytes += static_cast<size_t>(corrected);
+            }
+
+            packet.messageId = protectedBytes_[0];
+            std::copy(protectedBytes_.begin() + 1, protectedBytes_.begin() + dataSize, packet.payload.begin());
+            packet.status = FrameStatus::Ok;
+        }
+
+        packet.payload.resize(payloadSize);
+        result.status = damaged ? FecStatus::Corrected : FecStatus::Clean;
+        return result;
+    }
+
+    const ReedSolomon& code() const {
+        return code_;
+    }
+
+private:
+    //! Bytes of an interleaved stream of `total` bytes that fall into `block`
+    static size_t dataCount(size_t block, size_t blocks, size_t total) {
+        return (total - block + blocks - 1) / blocks;
+    }
+
+    //! Invert encodedSize(); false if no payload size encodes to this length
+    bool payloadSizeFor(size_t encoded, size_t& payloadSize) const {
+        for (size_t blocks = 1; blocks * code_.paritySymbols() <= encoded; blocks++) {
+            size_t candidate = encoded - blocks * code_.paritySymbols();
+            if (blockCount(candidate) == blocks) {
+                payloadSize = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ReedSolomon code_;
+    std::vector<uint8_t> protectedBytes_; //! Scratch for [ID][payload][parity]
+};
+
+} //! namespace serialflex
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "serialflex.hpp"
+#include <chrono>
+
+namespace serialflex {
+
+//! --------------------------------
+//! CREDIT-BASED FLOW CONTROL
+//! --------------------------------
+
+//! Settings shared by both ends of a CreditLink
+struct CreditConfig {
+    using Duration = std::chrono::microseconds;
+
+    uint8_t creditId = 0xF2;               //! Message ID of credit and probe frames
+    size_t frameCost = 7;                  //! Credit charged per frame on top of its payload
+    size_t maxQueuedBytes = 64 * 1024;     //! Sender queue bound; send() refuses beyond it
+    size_t maxPayloadSize = 1024;          //! Largest payload send() accepts; each end's capacity must hold one
+    size_t initialCredit = 0;              //! Credit assumed before the peer's first advertisement
+    Duration probeInterval = std::chrono::milliseconds(100); //! Ask for credit this often while blocked
+};
+
+//! Credit-based flow control, so a fast sender never overruns a slow receiver.
+//!
+//! Each end tells its peer how much it may send. It does so with a cumulative
+//! limit: bytes released by the application plus the receive capacity. Sending a
+//! frame costs its payload size plus config.frameCost. The sender queues frames
+//! and writes them only while they fit under the peer's limit, so nothing goes
+//! out that the receiver would have to drop.
+//!
+//! Control frames use config.creditId and carry [kind:8][counter:32, little-endian]:
+//!  - A credit frame carries the limit. A lost or duplicated one does no harm,
+//!    because the next one supersedes it.
+//!  - A sender blocked for probeInterval sends a probe with its cumulative sent
+//!    counter. The peer counts whatever it never received as lost, since the link
+//!    is in order and nothing older can still be on the way. It reclaims that room
+//!    and answers with its current limit.
+//! Lost credit updates and lost data frames thus stall a sender for at most one
+//! probe interval, without leaking window.
+//!
+//! A frame larger than the peer's capacity could never be sent, and would block
+//! every frame behind it. Both ends therefore share config.maxPayloadSize: the
+//! constructor rejects a receive capacity that cannot hold one such frame, and
+//! send() refuses larger payloads.
+//!
+//! Data frames keep their own message IDs and are not modified, so the peer's
+//! PacketReceiver and MessageRegistry see ordinary traffic. Like ArqLink, the link
+//! takes `now` on every call and has no thread; nextDeadline() says when tick()
+//! is due. sink(ByteSpan frame) writes one frame to the wire.
+template<typename Sink>
+class CreditLink {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    struct Stats {
+        uint64_t framesSent = 0;
+        uint64_t creditsSent = 0;      //! Advertisements, probe answers included
+        uint64_t probesSent = 0;
+        uint64_t refused = 0;          //! send() calls rejected by a full queue
+        uint64_t oversized = 0;        //! send() calls rejected for exceeding maxPayloadSize
+        uint64_t overruns = 0;         //! Frames that arrived beyond our limit and were dropped
+    };
+
+    //! receiveCapacity is what this end can hold of received payloads (plus frameCost each)
+    CreditLink(Sink sink, size_t receiveCapacity, CreditConfig config = CreditConfig())
+        : sink_(std::move(sink)), config_(config), receiveCapacity_(receiveCapacity),
+          peerLimit_(static_cast<uint32_t>(config.initialCredit)) {
+        if (receiveCapacity >= MAX_WINDOW || config.initialCredit >= MAX_WINDOW) {
+            throw std::invalid_argument("Credit window exceeds half the counter range");
+        }
+        if (config.maxPayloadSize + config.frameCost > receiveCapacity) {
+            throw std::invalid_argument("Receive capacity cannot hold a frame of maxPayloadSize");
+        }
+    }
+
+    //! Announce our receive limit; call once when the link comes up
+    void advertise() {
+        advertisedLimit_ = receiveLimit();
+        sendControl(CREDIT, advertisedLimit_);
+        stats_.creditsSent++;
+    }
+
+    //! Queue a message and send whatever the peer has room for. Returns false, and
+    //! queues nothing, when the payload exceeds maxPayloadSize or the queue already
+    //! holds maxQueuedBytes.
+    bool send(uint8_t messageId, ByteSpan payload, TimePoint now) {
+        if (payload.size() > config_.maxPayloadSize) {
+            stats_.oversized++;
+            return false;
+        }
+        if (queuedBytes_ + payload.size() > config_.maxQueuedBytes && !queue_.empty()) {
+            stats_.refused++;
+            return false;
+        }
+
+        QueuedFrame entry;
+        if (!spare_.empty()) {
+            entry.frame = std::move(spare_.back());
+            spare_.pop_back();
+        }
+        PacketFramer::framePacketInto(entry.frame, messageId, payload);
+        entry.cost = cost(payload.size());
+        queuedBytes_ += payload.size();
+        queue_.push_back(std::move(entry));
+
+        pump(now);
+        return true;
+    }
+
+    //! Serialize and send a message
+    template<typename T>
+    bool sendMessage(uint8_t messageId, const T& data, TimePoint now) {
+        return send(messageId, ByteSpan(serialize(data)), now);
+    }
+
+    //! Feed a frame from the wire. Credit frames update what we may send and
+    //! release queued frames; data frames within our limit go to
+    //! onMessage(uint8_t messageId, ByteSpan payload). Call release() once the
+    //! application no longer holds a delivered payload.
+    //! Returns false for frames that failed validation.
+    template<typename OnMessage>
+    bool receive(const DeframedPacket& packet, TimePoint now, OnMessage&& onMessage) {
+        if (!packet.valid()) {
+            return false;
+        }
+        if (packet.messageId == config_.creditId) {
+            if (packet.payload.size() == 5) {
+                const uint8_t* bytes = packet.payload.data();
+                uint32_t counter = bytes[1] | (bytes[2] << 8) | (bytes[3] << 16) | (static_cast<uint32_t>(bytes[4]) << 24);
+                if (bytes[0] == CREDIT) {
+                    if (ahead(counter, peerLimit_)) {
+                        peerLimit_ = counter;
+                    }
+                    probeDeadline_ = TimePoint::max();
+                    pump(now);
+                } else if (bytes[0] == PROBE) {
+                    //! Everything sent before the probe has arrived or is gone for good
+                    if (ahead(counter, received_)) {
+                        received_ = counter;
+                    }
+                    advertise();
+                }
+            }
+            return true;
+        }
+
+        uint32_t charge = cost(packet.payload.size());
+        if (held_ + charge > receiveCapacity_) {
+            stats_.overruns++;
+            return true;
+        }
+        received_ += charge;
+        held_ += charge;
+        onMessage(packet.messageId, ByteSpan(packet.payload));
+        return true;
+    }
+
+    //! Return the room taken by a delivered payload of the given size. The peer
+    //! hears about it once a quarter of the capacity has been freed, or when it probes.
+    void release(size_t payloadSize) {
+        held_ -= std::min<size_t>(held_, cost(payloadSize));
+        if (static_cast<uint32_t>(receiveLimit() - advertisedLimit_) >= std::max<size_t>(receiveCapacity_ / 4, 1)) {
+            advertise();
+        }
+    }
+
+    //! Probe for credit when blocked for too long
+    void tick(TimePoint now) {
+        if (now >= probeDeadline_) {
+            sendControl(PROBE, sent_);
+            stats_.probesSent++;
+            probeDeadline_ = now + config_.probeInterval;
+        }
+    }
+
+    //! When tick() next has work to do; TimePoint::max() when not blocked
+    TimePoint nextDeadline() const {
+        return probeDeadline_;
+    }
+
+    //! Credit left before the peer's limit
+    size_t availableCredit() const {
+        return ahead(peerLimit_, sent_) ? static_cast<uint32_t>(peerLimit_ - sent_) : 0;
+    }
+
+    //! True while queued frames wait for credit
+    bool blocked() const {
+        return !queue_.empty();
+    }
+
+    size_t queuedFrames() const {
+        return queue_.size();
+    }
+
+    //! Payload bytes waiting in the queue
+    size_t queuedBytes() const {
+        return queuedBytes_;
+    }
+
+    const Stats& stats() const {
+        return stats_;
+    }
+
+private:
+    //! Counters wrap; limits stay within half the range of what was counted
+    static constexpr size_t MAX_WINDOW = size_t(1) << 31;
+
+    //! Control frame kinds
+    static constexpr uint8_t CREDIT = 0;
+    static constexpr uint8_t PROBE = 1;
+
+    struct QueuedFrame {
+        std::vector<uint8_t> frame;
+        uint32_t cost = 0;
+    };
+
+    uint32_t cost(size_t payloadSize) const {
+        return static_cast<uint32_t>(payloadSize + config_.frameCost);
+    }
+
+    //! True if counter a is past b
+    static bool ahead(uint32_t a, uint32_t b) {
+        return static_cast<int32_t>(a - b) > 0;
+    }
+
+    //! The peer may send until its sent counter reaches this
+    uint32_t receiveLimit() const {
+        return static_cast<uint32_t>(received_ + receiveCapacity_ - held_);
+    }
+
+    void sendControl(uint8_t kind, uint32_t counter) {
+        uint8_t payload[5] = {kind, static_cast<uint8_t>(counter), static_cast<uint8_t>(counter >> 8),
+                              static_cast<uint8_t>(counter >> 16), static_cast<uint8_t>(counter >> 24)};
+        PacketFramer::framePacketInto(controlFrame_, config_.creditId, ByteSpan(payload, sizeof(payload)));
+        sink_(ByteSpan(controlFrame_));
+    }
+
+    void pump(TimePoint now) {
+        while (!queue_.empty() && queue_.front().cost <= availableCredit()) {
+            QueuedFrame& entry = queue_.front();
+            sink_(ByteSpan(entry.frame));
+            sent_ += entry.cost;
+            queuedBytes_ -= entry.cost - config_.frameCost;
+            stats_.framesSent++;
+            spare_.push_back(std::move(entry.frame));
+            queue_.pop_front();
+        }
+
+        //! Frames left behind wait for credit; make sure we ask if it does not come
+        if (queue_.empty()) {
+            probeDeadline_ = TimePoint::max();
+        } else if (probeDeadline_ == TimePoint::max()) {
+            probeDeadline_ = now + config_.probeInterval;
+        }
+    }
+
+    Sink sink_;
+    CreditConfig config_;
+    size_t receiveCapacity_;
+
+    //! Sending: cumulative cost sent, and the peer's last advertised limit
+    uint32_t sent_ = 0;
+    uint32_t peerLimit_;
+    std::deque<QueuedFrame> queue_;
+    std::vector<std::vector<uint8_t>> spare_;  //! Frame buffers recycled from sent frames
+    size_t queuedBytes_ = 0;
+    TimePoint probeDeadline_ = TimePoint::max();
+
+    //! Receiving: cumulative cost received (or written off), room held by the
+    //! application, and the limit last announced
+    uint32_t received_ = 0;
+    size_t held_ = 0;
+    uint32_t advertisedLimit_ = 0;
+    std::vector<uint8_t> controlFrame_;
+
+    Stats stats_;
+};
+
+} //! namespace serialflex
@@ -0,0 +1,530 @@
+#pragma once
+
+#include "serialflex.hpp"
+#include "serialflex_queue.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <variant>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace serialflex {
+
+//! --------------------------------
+//! WORK-STEALING THREAD POOL
+//! --------------------------------
+
+//! Fixed pool of threads running index-range jobs with work stealing.
+//! parallelFor(count, body) splits [0, count) into one contiguous range per thread.
+//! Each thread works through its own range front to back and, once it runs dry,
+//! steals the upper half of another thread's remaining range. Uneven tasks (dense
+//! and sparse regions of a capture, large and small messages) therefore balance
+//! themselves without a shared queue. The calling thread takes part in every job.
+class ThreadPool {
+public:
+    //! threadCount = 0 uses one thread per hardware thread; the caller counts as one
+    explicit ThreadPool(size_t threadCount = 0) : generation_(0), busy_(0), stopping_(false), failed_(false) {
+        if (threadCount == 0) {
+            threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        threadCount_ = threadCount;
+        queues_ = std::make_unique<Range[]>(threadCount);
+        threads_.reserve(threadCount - 1);
+        for (size_t i = 1; i < threadCount; i++) {
+            threads_.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+    
+    //! Call body(i) for every i in [0, count), in parallel, and wait for all of them.
+    //! The first exception thrown by body is rethrown here; remaining tasks are skipped.
+    //! Jobs from different threads run one after another; body must not call parallelFor.
+    template<typename Body>
+    void parallelFor(size_t count, Body&& body) {
+        if (count == 0) {
+            return;
+        }
+        
+        std::lock_guard<std::mutex> job(jobMutex_);
+        using B = std::remove_reference_t<Body>;
+        context_ = static_cast<void*>(&body);
+        invoke_ = [](void* context, size_t index) { (*static_cast<B*>(context))(index); };
+        failed_.store(false, std::memory_order_relaxed);
+        error_ = nullptr;
+        
+        for (size_t i = 0; i < threadCount_; i++) {
+            std::lock_guard<std::mutex> lock(queues_[i].mutex);
+            queues_[i].begin = count * i / threadCount_;
+            queues_[i].end = count * (i + 1) / threadCount_;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            generation_++;
+            busy_ = threadCount_ - 1;
+        }
+        wakeup_.notify_all();
+        
+        runTasks(0);
+        
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this] { return busy_ == 0; });
+        }
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+    
+    size_t threadCount() const {
+        return threadCount_;
+    }
+
+private:
+    //! Remaining task indices [begin, end) owned by one thread
+    struct alignas(SERIALFLEX_CACHE_LINE_SIZE) Range {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+    
+    void workerLoop(size_t self) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeup_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) {
+                    return;
+                }
+                seen = generation_;
+            }
+            
+            runTasks(self);
+            
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+    
+    void runTasks(size_t self) {
+        size_t index;
+        while (takeLocal(self, index) || steal(self, index)) {
+            if (failed_.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            try {
+                invoke_(context_, index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                failed_.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    bool takeLocal(size_t self, size_t& index) {
+        Range& range = queues_[self];
+        std::lock_guard<std::mutex> lock(range.mutex);
+        if (range.begin == range.end) {
+            return false;
+        }
+        index = range.begin++;
+        return true;
+    }
+    
+    //! Take the upper half of another thread's range; our own range is empty here
+    bool steal(size_t self, size_t& index) {
+        for (size_t k = 1; k < threadCount_; k++) {
+            Range& victim = queues_[(self + k) % threadCount_];
+            size_t begin;
+            size_t end;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.begin == victim.end) {
+                    continue;
+                }
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                end = victim.end;
+                victim.end = begin;
+            }
+            
+            index = begin;
+            if (begin + 1 < end) {
+                Range& own = queues_[self];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                own.begin = begin + 1;
+                own.end = end;
+            }
+            return true;
+        }
+        return false;
+    }
+    
+    size_t threadCount_;
+    std::unique_ptr<Range[]> queues_;
+    std::vector<std::thread> threads_;
+    
+    std::mutex jobMutex_;                   //! Serializes parallelFor calls
+    std::mutex mutex_;                      //! Guards generation_, busy_, stopping_ and error_
+    std::condition_variable wakeup_;
+    std::condition_variable done_;
+    uint64_t generation_;
+    size_t busy_;                           //! Pool threads still working on the current job
+    bool stopping_;
+    
+    void* context_ = nullptr;
+    void (*invoke_)(void*, size_t) = nullptr;
+    std::atomic<bool> failed_;
+    std::exception_ptr error_;
+};
+
+//! --------------------------------
+//! PARALLEL CAPTURE PARSING
+//! --------------------------------
+
+//! Capture bytes handed to one parse task by default
+inline constexpr size_t DEFAULT_CAPTURE_CHUNK_SIZE = 1024 * 1024;
+
+//! A valid frame found in a capture, as passed to the decode function
+struct CapturedFrame {
+    size_t offset = 0;     //! Position of the START_BYTE in the capture
+    uint8_t messageId = 0;
+    ByteSpan payload;      //! Unstuffed payload, valid during the decode call only
+};
+
+//! Decoded frames of a capture in capture order, plus frame counts
+template<typename R>
+struct CaptureResult {
+    std::vector<R> values;
+    ValidationSummary summary;
+};
+
+namespace detail {
+    //! First position in [pos, limit) where a valid frame begins, or limit if there is none
+    inline size_t nextFrameBoundary(ByteSpan capture, size_t pos, size_t limit) {
+        while (pos < limit) {
+            const void* start = std::memchr(capture.data() + pos, PacketFramer::START_BYTE, limit - pos);
+            if (start == nullptr) {
+                return limit;
+            }
+            pos = static_cast<size_t>(static_cast<const uint8_t*>(start) - capture.data());
+            if (PacketFramer::validateLeadingFrame(capture.subspan(pos, capture.size() - pos)).valid()) {
+                return pos;
+            }
+            pos++;
+        }
+        return limit;
+    }
+    
+    //! Scan like PacketFramer::validateFrames from pos, stopping at the first candidate at
+    //! or after stop. Frames that begin before stop may extend past it. Returns where the
+    //! scan ended, which is where a sequential scan would pick up.
+    template<typename Decode, typename R>
+    size_t parseCaptureRange(ByteSpan capture, size_t pos, size_t stop, Decode& decode,
+                             CaptureResult<R>& out, PayloadBuffer& scratch) {
+        while (pos < stop) {
+            const void* start = std::memchr(capture.data() + pos, PacketFramer::START_BYTE, stop - pos);
+            if (start == nullptr) {
+                return stop;
+            }
+            pos = static_cast<size_t>(static_cast<const uint8_t*>(start) - capture.data());
+            
+            FrameView view = PacketFramer::validateLeadingFrame(capture.subspan(pos, capture.size() - pos));
+            if (!view.valid()) {
+                out.summary.invalidFrames++;
+                pos++;
+                continue;
+            }
+            
+            CapturedFrame frame;
+            frame.offset = pos;
+            frame.messageId = view.messageId;
+            if (view.stuffed()) {
+                PacketFramer::unstuffPayload(view, scratch);
+                frame.payload = ByteSpan(scratch);
+            } else {
+                frame.payload = view.payload;
+            }
+            out.values.push_back(decode(static_cast<const CapturedFrame&>(frame)));
+            out.summary.validFrames++;
+            pos += view.frame.size();
+        }
+        return pos;
+    }
+}
+
+//! Find and decode every frame of a large capture on a thread pool.
+//! The capture is cut into chunks of about chunkSize bytes. Each task moves its
+//! edges forward to the next START_BYTE that begins a valid frame, then validates,
+//! unstuffs and calls decode(const CapturedFrame&) on every frame in its chunk.
+//! Results are merged in capture order and match PacketFramer::validateFrames run
+//! over the whole buffer: in the rare case a frame straddles a chosen edge, the
+//! following chunk is rescanned serially from where the frame ended.
+//! decode runs concurrently on several threads and its exceptions propagate.
+template<typename Decode>
+auto parseCapture(ByteSpan capture, ThreadPool& pool, Decode&& decode,
+                  size_t chunkSize = DEFAULT_CAPTURE_CHUNK_SIZE) {
+    using R = std::decay_t<std::invoke_result_t<Decode&, const CapturedFrame&>>;
+    static_assert(!std::is_void_v<R>, "Decode function must return the decoded value");
+    
+    if (chunkSize == 0) {
+        throw std::invalid_argument("Capture chunk size must be non-zero");
+    }
+    size_t chunkCount = std::max<size_t>(1, (capture.size() + chunkSize - 1) / chunkSize);
+    
+    //! Edge k (1 <= k < chunkCount) starts its search at k * chunkSize and is computed
+    //! identically by both neighbouring tasks
+    auto edge = [&](size_t k) {
+        if (k == 0) {
+            return size_t(0);
+        }
+        if (k == chunkCount) {
+            return capture.size();
+        }
+        return detail::nextFrameBoundary(capture, k * chunkSize, std::min(capture.size(), (k + 1) * chunkSize));
+    };
+    
+    struct Part {
+        size_t begin = 0;
+        size_t end = 0;
+        size_t stop = 0;
+        CaptureResult<R> result;
+    };
+    std::vector<Part> parts(chunkCount);
+    
+    pool.parallelFor(chunkCount, [&](size_t k) {
+        Part& part = parts[k];
+        PayloadBuffer scratch;
+        part.begin = edge(k);
+        part.end = edge(k + 1);
+        part.stop = detail::parseCaptureRange(capture, part.begin, part.end, decode, part.result, scratch);
+    });
+    
+    CaptureResult<R> merged;
+    PayloadBuffer scratch;
+    size_t pos = 0;
+    for (Part& part : parts) {
+        if (part.begin != pos) {
+            //! The previous chunk's last frame ran past our edge
+            part.result = CaptureResult<R>();
+            part.stop = detail::parseCaptureRange(capture, pos, part.end, decode, part.result, scratch);
+        }
+        if (merged.values.empty()) {
+            merged.values = std::move(part.result.values);
+        } else {
+            merged.values.insert(merged.values.end(), std::make_move_iterator(part.result.values.begin()),
+                                 std::make_move_iterator(part.result.values.end()));
+        }
+        merged.summary.validFrames += part.result.summary.validFrames;
+        merged.summary.invalidFrames += part.result.summary.invalidFrames;
+        pos = std::max(pos, part.stop);
+    }
+    return merged;
+}
+
+//! Read-only view of a whole file; memory-mapped where the platform supports it
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open capture file: " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat capture file: " + path);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ > 0) {
+            void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map capture file: " + path);
+            }
+            mapping_ = static_cast<const uint8_t*>(mapping);
+            ::madvise(mapping, size_, MADV_WILLNEED);
+        }
+        ::close(fd);
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot open capture file: " + path);
+        }
+        contents_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        mapping_ = contents_.data();
+        size_ = contents_.size();
+#endif
+    }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapping_ != nullptr) {
+            ::munmap(const_cast<uint8_t*>(mapping_), size_);
+        }
+#endif
+    }
+    
+    ByteSpan bytes() const {
+        return ByteSpan(mapping_, size_);
+    }
+
+private:
+    const uint8_t* mapping_ = nullptr;
+    size_t size_ = 0;
+#if !(defined(__unix__) || defined(__APPLE__))
+    std::vector<uint8_t> contents_;
+#endif
+};
+
+//! parseCapture over a capture file, mapped rather than read into memory
+template<typename Decode>
+auto parseCaptureFile(const std::string& path, ThreadPool& pool, Decode&& decode,
+                      size_t chunkSize = DEFAULT_CAPTURE_CHUNK_SIZE) {
+    MappedFile file(path);
+    return parseCapture(file.bytes(), pool, std::forward<Decode>(decode), chunkSize);
+}
+
+//! --------------------------------
+//! PARALLEL BATCH ENCODING
+//! --------------------------------
+
+//! Messages encoded by one encode task by default
+inline constexpr size_t DEFAULT_ENCODE_BLOCK_SIZE = 256;
+
+//! Framed packets stored back to back in one buffer.
+//! Packet i occupies bytes [offsets[i], offsets[i + 1]), so the whole batch can go
+//! out with one write() and any sub-range maps directly onto iovec entries.
+struct PacketBatch {
+    std::vector<uint8_t> bytes;
+    std::vector<size_t> offsets;  //! One entry per packet plus the total size
+    
+    size_t size() const {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+    
+    ByteSpan packet(size_t index) const {
+        return ByteSpan(bytes.data() + offsets[index], offsets[index + 1] - offsets[index]);
+    }
+};
+
+namespace detail {
+    //! Frame count messages on the pool. appendOne(index, out) appends packet index
+    //! to out; blocks of messages are framed into separate buffers in parallel, then
+    //! copied in parallel into the final buffer at their prefix-summed offsets.
+    template<typename AppendOne>
+    PacketBatch encodeBatch(size_t count, ThreadPool& pool, size_t blockSize, AppendOne&& appendOne) {
+        if (blockSize == 0) {
+            throw std::invalid_argument("Encode block size must be non-zero");
+        }
+        
+        PacketBatch batch;
+        batch.offsets.resize(count + 1);
+        size_t blockCount = (count + blockSize - 1) / blockSize;
+        std::vector<std::vector<uint8_t>> blocks(blockCount);
+        
+        pool.parallelFor(blockCount, [&](size_t block) {
+            std::vector<uint8_t>& out = blocks[block];
+            size_t end = std::min(count, (block + 1) * blockSize);
+            for (size_t i = block * blockSize; i < end; i++) {
+                batch.offsets[i] = out.size(); //! Relative to the block for now
+                appendOne(i, out);
+            }
+        });
+        
+        std::vector<size_t> blockOffsets(blockCount + 1, 0);
+        for (size_t block = 0; block < blockCount; block++) {
+            blockOffsets[block + 1] = blockOffsets[block] + blocks[block].size();
+        }
+        
+        batch.bytes.resize(blockOffsets[blockCount]);
+        batch.offsets[count] = blockOffsets[blockCount];
+        pool.parallelFor(blockCount, [&](size_t block) {
+            const std::vector<uint8_t>& out = blocks[block];
+            if (!out.empty()) {
+                std::memcpy(batch.bytes.data() + blockOffsets[block], out.data(), out.size());
+            }
+            size_t end = std::min(count, (block + 1) * blockSize);
+            for (size_t i = block * blockSize; i < end; i++) {
+                batch.offsets[i] += blockOffsets[block];
+            }
+            std::vector<uint8_t>().swap(blocks[block]);
+        });
+        
+        return batch;
+    }
+    
+    template<typename T>
+    void appendMessage(std::vector<uint8_t>& out, uint8_t messageId, const T& data) {
+        std::vector<uint8_t> serialized = serialize(data);
+        PacketFramer::appendPacket(out, messageId, ByteSpan(serialized));
+    }
+}
+
+//! Serialize and frame many messages of one type in parallel.
+//! The result is byte-identical to calling createPacket on each message and
+//! concatenating the packets.
+template<typename T>
+PacketBatch createPackets(uint8_t messageId, Span<const T> messages, ThreadPool& pool,
+                          size_t blockSize = DEFAULT_ENCODE_BLOCK_SIZE) {
+    return detail::encodeBatch(messages.size(), pool, blockSize, [&](size_t i, std::vector<uint8_t>& out) {
+        detail::appendMessage(out, messageId, messages[i]);
+    });
+}
+
+template<typename T>
+PacketBatch createPackets(uint8_t messageId, const std::vector<T>& messages, ThreadPool& pool,
+                          size_t blockSize = DEFAULT_ENCODE_BLOCK_SIZE) {
+    return createPackets(messageId, Span<const T>(messages.data(), messages.size()), pool, blockSize);
+}
+
+//! Frame a mixed batch in parallel; each message goes out under the ID its type
+//! is bound to in Registry (see MessageRegistry)
+template<typename Registry, typename... Ts>
+PacketBatch createPackets(Span<const std::variant<Ts...>> messages, ThreadPool& pool,
+                          size_t blockSize = DEFAULT_ENCODE_BLOCK_SIZE) {
+    return detail::encodeBatch(messages.size(), pool, blockSize, [&](size_t i, std::vector<uint8_t>& out) {
+        std::visit([&](const auto& data) {
+            using T = std::decay_t<decltype(data)>;
+            detail::appendMessage(out, Registry::template idOf<T>(), data);
+        }, messages[i]);
+    });
+}
+
+template<typename Registry, typename... Ts>
+PacketBatch createPackets(const std::vector<std::variant<Ts...>>& messages, ThreadPool& pool,
+                          size_t blockSize = DEFAULT_ENCODE_BLOCK_SIZE) {
+    return createPackets<Registry>(Span<const std::variant<Ts...>>(messages.data(), messages.size()),
+                                   pool, blockSize);
+}
+
+} //! namespace serialflex
@@ -0,0 +1,319 @@
+#pragma once
+
+#include "serialflex.hpp"
+#include "serialflex_queue.hpp"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace serialflex {
+
+//! --------------------------------
+//! RECEIVE PIPELINE
+//! --------------------------------
+
+namespace detail {
+    //! Bounded single-producer/single-consumer byte ring.
+    //! The producer copies raw chunks in; the consumer reads contiguous regions in place.
+    class ByteRing {
+    public:
+        explicit ByteRing(size_t capacity)
+            : buffer_(roundUpToPowerOfTwo(std::max<size_t>(capacity, 64))), mask_(buffer_.size() - 1), head_(0), tail_(0) {}
+        
+        //! Producer side: copy as much of data as fits, returns the number of bytes taken
+        size_t write(ByteSpan data) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            size_t head = head_.load(std::memory_order_acquire);
+            size_t count = std::min(data.size(), buffer_.size() - (tail - head));
+            if (count == 0) {
+                return 0;
+            }
+            
+            size_t offset = tail & mask_;
+            size_t first = std::min(count, buffer_.size() - offset);
+            std::memcpy(buffer_.data() + offset, data.data(), first);
+            if (count > first) {
+                std::memcpy(buffer_.data(), data.data() + first, count - first);
+            }
+            tail_.store(tail + count, std::memory_order_release);
+            return count;
+        }
+        
+        //! Consumer side: the next contiguous run of readable bytes (may be empty)
+        ByteSpan peek() const {
+            size_t head = head_.load(std::memory_order_relaxed);
+            size_t tail = tail_.load(std::memory_order_acquire);
+            size_t offset = head & mask_;
+            return ByteSpan(buffer_.data() + offset, std::min(tail - head, buffer_.size() - offset));
+        }
+        
+        //! Consumer side: release bytes returned by peek()
+        void consume(size_t count) {
+            head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+        
+        bool empty() const {
+            return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+        }
+    
+    private:
+        std::vector<uint8_t> buffer_;
+        size_t mask_;
+        alignas(SERIALFLEX_CACHE_LINE_SIZE) std::atomic<size_t> head_; //! Written by the consumer only
+        alignas(SERIALFLEX_CACHE_LINE_SIZE) std::atomic<size_t> tail_; //! Written by the producer only
+    };
+}
+
+//! Multi-threaded receive path for many links.
+//!
+//!   reader threads --submit()--> per-link SPSC byte rings --> worker threads
+//!                                (PacketReceiver + Registry::dispatch + handler)
+//!
+//! Links are sharded across workers (link % workerCount), so each link is framed,
+//! decoded and handled by exactly one worker and its messages are delivered in
+//! arrival order without locks. Throughput scales with cores as long as there are
+//! at least as many busy links as workers.
+//!
+//! Each link must have a single producer thread; one reader may serve many links.
+//! The handler is called as handler(link, message) with every type in Registry.
+//! Calls for one link are serialized, calls for different links may run concurrently.
+template<typename Registry, typename Handler>
+class ReceivePipeline {
+public:
+    //! Default per-link ring size in bytes
+    static constexpr size_t DEFAULT_RING_CAPACITY = 16 * 1024;
+    
+    //! Snapshot of per-link counters
+    struct LinkStats {
+        uint64_t bytes = 0;          //! Bytes framed
+        uint64_t packets = 0;        //! Messages decoded and handed to the handler
+        uint64_t frameErrors = 0;    //! Frames rejected by the PacketReceiver
+        uint64_t dispatchErrors = 0; //! Valid frames with an unknown ID or undecodable payload
+    };
+    
+    //! workerCount = 0 uses one worker per hardware thread (never more than linkCount)
+    ReceivePipeline(size_t linkCount, Handler handler, size_t workerCount = 0,
+                    size_t ringCapacity = DEFAULT_RING_CAPACITY,
+                    size_t maxPayloadSize = PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE)
+        : handler_(std::move(handler)), stopping_(false) {
+        if (linkCount == 0) {
+            throw std::invalid_argument("Receive pipeline needs at least one link");
+        }
+        if (workerCount == 0) {
+            workerCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        workerCount = std::min(workerCount, linkCount);
+        
+        links_.reserve(linkCount);
+        for (size_t i = 0; i < linkCount; i++) {
+            links_.push_back(std::make_unique<Link>(ringCapacity, maxPayloadSize));
+        }
+        workers_.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; i++) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < workerCount; i++) {
+            workers_[i]->thread = std::thread([this, i] { run(i); });
+        }
+    }
+    
+    ReceivePipeline(const ReceivePipeline&) = delete;
+    ReceivePipeline& operator=(const ReceivePipeline&) = delete;
+    
+    ~ReceivePipeline() {
+        stop();
+    }
+    
+    //! Queue raw bytes received on a link without blocking.
+    //! Returns how many bytes were accepted; fewer than data.size() means the ring is full.
+    size_t trySubmit(size_t link, ByteSpan data) {
+        size_t accepted = links_[link]->ring.write(data);
+        if (accepted > 0) {
+            wake(*workers_[link % workers_.size()]);
+        }
+        return accepted;
+    }
+    
+    //! Queue raw bytes received on a link, yielding while its ring is full
+    void submit(size_t link, ByteSpan data) {
+        while (!data.empty()) {
+            size_t accepted = trySubmit(link, data);
+            data = data.subspan(accepted, data.size() - accepted);
+            if (!data.empty()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    //! Process everything submitted so far, then stop and join the workers.
+    //! Call after all producers have finished submitting.
+    void stop() {
+        if (stopping_.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        for (auto& worker : workers_) {
+            {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+                worker->sleeping.store(false, std::memory_order_relaxed);
+            }
+            worker->wakeup.notify_one();
+        }
+        for (auto& worker : workers_) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    }
+    
+    LinkStats stats(size_t link) const {
+        const Counters& counters = links_[link]->counters;
+        LinkStats result;
+        result.bytes = counters.bytes.load(std::memory_order_relaxed);
+        result.packets = counters.packets.load(std::memory_order_relaxed);
+        result.frameErrors = counters.frameErrors.load(std::memory_order_relaxed);
+        result.dispatchErrors = counters.dispatchErrors.load(std::memory_order_relaxed);
+        return result;
+    }
+    
+    size_t linkCount() const {
+        return links_.size();
+    }
+    
+    size_t workerCount() const {
+        return workers_.size();
+    }
+
+private:
+    //! Idle passes a worker spins through before it sleeps
+    static constexpr int SPIN_PASSES = 64;
+    
+    struct Counters {
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> packets{0};
+        std::atomic<uint64_t> frameErrors{0};
+        std::atomic<uint64_t> dispatchErrors{0};
+    };
+    
+    struct Link {
+        Link(size_t ringCapacity, size_t maxPayloadSize) : ring(ringCapacity), receiver(maxPayloadSize) {}
+        
+        detail::ByteRing ring;
+        PacketReceiver receiver; //! Touched only by the owning worker
+        Counters counters;
+    };
+    
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::atomic<bool> sleeping{false};
+    };
+    
+    //! Counters have a single writer, so a plain load/store avoids a locked RMW
+    static void bump(std::atomic<uint64_t>& counter, uint64_t amount = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+    
+    void wake(Worker& worker) {
+        //! Pairs with the fence in sleep(): either the worker sees the new bytes or we see it sleeping
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (worker.sleeping.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.sleeping.store(false, std::memory_order_relaxed);
+            }
+            worker.wakeup.notify_one();
+        }
+    }
+    
+    void run(size_t index) {
+        DeframedPacket packet;
+        int idlePasses = 0;
+        
+        for (;;) {
+            if (drainShard(index, packet)) {
+                idlePasses = 0;
+                continue;
+            }
+            if (stopping_.load(std::memory_order_acquire)) {
+                //! Producers are done; whatever they submitted is visible now
+                while (drainShard(index, packet)) {}
+                return;
+            }
+            if (++idlePasses < SPIN_PASSES) {
+                detail::cpuRelax();
+                continue;
+            }
+            idlePasses = 0;
+            sleep(index);
+        }
+    }
+    
+    void sleep(size_t index) {
+        Worker& worker = *workers_[index];
+        worker.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        
+        if (hasPendingData(index) || stopping_.load(std::memory_order_acquire)) {
+            worker.sleeping.store(false, std::memory_order_relaxed);
+            return;
+        }
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        worker.wakeup.wait(lock, [&] { return !worker.sleeping.load(std::memory_order_relaxed); });
+    }
+    
+    bool hasPendingData(size_t index) const {
+        for (size_t link = index; link < links_.size(); link += workers_.size()) {
+            if (!links_[link]->ring.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    //! One contiguous region per link and pass, so a busy link cannot starve its neighbours
+    bool drainShard(size_t index, DeframedPacket& packet) {
+        bool progressed = false;
+        for (size_t link = index; link < links_.size(); link += workers_.size()) {
+            Link& state = *links_[link];
+            ByteSpan chunk = state.ring.peek();
+            if (chunk.empty()) {
+                continue;
+            }
+            
+            for (uint8_t byte : chunk) {
+                if (state.receiver.processByte(byte, packet)) {
+                    deliver(link, state, packet);
+                }
+            }
+            state.ring.consume(chunk.size());
+            bump(state.counters.bytes, chunk.size());
+            progressed = true;
+        }
+        return progressed;
+    }
+    
+    void deliver(size_t link, Link& state, const DeframedPacket& packet) {
+        if (!packet.valid()) {
+            bump(state.counters.frameErrors);
+            return;
+        }
+        
+        auto bound = [this, link](auto&& message) {
+            handler_(link, std::forward<decltype(message)>(message));
+        };
+        if (Registry::dispatch(packet, bound) == DispatchResult::Handled) {
+            bump(state.counters.packets);
+        } else {
+            bump(state.counters.dispatchErrors);
+        }
+    }
+    
+    Handler handler_;
+    std::vector<std::unique_ptr<Link>> links_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<bool> stopping_;
+};
+
+} //! namespace serialflex
@@ -0,0 +1,609 @@
+#pragma once
+
+#include "serialflex.hpp"
+#include <atomic>
+#include <thread>
+#include <climits>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#endif
+
+namespace serialflex {
+
+//! --------------------------------
+//! THREAD HANDOFF QUEUES
+//! --------------------------------
+
+//! Alignment used to keep producer- and consumer-owned state on separate cache lines
+#ifndef SERIALFLEX_CACHE_LINE_SIZE
+#define SERIALFLEX_CACHE_LINE_SIZE 64
+#endif
+
+namespace detail {
+    //! Hint to the CPU that we are busy-waiting
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#endif
+    }
+    
+    inline size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32-bit word");
+    
+    inline void futexWait(std::atomic<uint32_t>& word, uint32_t expected) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    }
+    
+    inline void futexWakeAll(std::atomic<uint32_t>& word) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+#endif
+}
+
+//! Wait strategies decide what a blocked push/pop does while the queue is full or empty.
+//! waitUntil(ready) returns once ready() is true; notify() is called after every change.
+
+//! Busy-spin: lowest latency, burns a core while waiting
+struct SpinWait {
+    template<typename Ready>
+    void waitUntil(Ready&& ready) {
+        while (!ready()) {
+            detail::cpuRelax();
+        }
+    }
+    
+    void notify() {}
+};
+
+//! Spin briefly, then yield the time slice between checks
+struct YieldWait {
+    static constexpr int SPIN_LIMIT = 128;
+    
+    template<typename Ready>
+    void waitUntil(Ready&& ready) {
+        for (int i = 0; i < SPIN_LIMIT; i++) {
+            if (ready()) {
+                return;
+            }
+            detail::cpuRelax();
+        }
+        while (!ready()) {
+            std::this_thread::yield();
+        }
+    }
+    
+    void notify() {}
+};
+
+//! Spin briefly, then sleep in the kernel (futex on Linux) until notified.
+//! notify() only makes a system call when a waiter is actually asleep.
+class FutexWait {
+public:
+    static constexpr int SPIN_LIMIT = 128;
+    
+    template<typename Ready>
+    void waitUntil(Ready&& ready) {
+        for (int i = 0; i < SPIN_LIMIT; i++) {
+            if (ready()) {
+                return;
+            }
+            detail::cpuRelax();
+        }
+        while (!ready()) {
+            uint32_t epoch = epoch_.load(std::memory_order_acquire);
+            waiters_.fetch_add(1, std::memory_order_relaxed);
+            //! Pairs with the fence in notify(): either we see the change or the notifier sees us
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!ready()) {
+                sleep(epoch);
+            }
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) != 0) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            wakeAll();
+        }
+    }
+
+private:
+    void sleep(uint32_t epoch) {
+#if defined(__linux__)
+        detail::futexWait(epoch_, epoch);
+#elif defined(__cpp_lib_atomic_wait)
+        epoch_.wait(epoch, std::memory_order_acquire);
+#else
+        (void)epoch;
+        std::this_thread::yield();
+#endif
+    }
+    
+    void wakeAll() {
+#if defined(__linux__)
+        detail::futexWakeAll(epoch_);
+#elif defined(__cpp_lib_atomic_wait)
+        epoch_.notify_all();
+#endif
+    }
+    
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<uint32_t> waiters_{0};
+};
+
+//! Bounded lock-free single-producer/single-consumer ring.
+//! Head and tail live on separate cache lines and each side keeps a cached copy of
+//! the other's index, so the shared lines are only touched when the ring looks full
+//! or empty. Batch operations publish all items with a single release store.
+template<typename T, typename Wait = YieldWait>
+class SpscQueue {
+    static_assert(std::is_default_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                  "Queue elements must be default constructible and nothrow movable");
+
+public:
+    explicit SpscQueue(size_t capacity)
+        : slots_(new T[detail::roundUpToPowerOfTwo(std::max<size_t>(capacity, 2))]),
+          capacity_(detail::roundUpToPowerOfTwo(std::max<size_t>(capacity, 2))), mask_(capacity_ - 1) {}
+    
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+    
+    //! Producer: push one item if there is room
+    bool tryPush(const T& item) {
+        return pushOne(item);
+    }
+    
+    bool tryPush(T&& item) {
+        return pushOne(std::move(item));
+    }
+    
+    //! Producer: push up to count items, returns how many were queued
+    size_t tryPush(const T* items, size_t count) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t n = std::min(count, freeSlots(tail, count));
+        if (n == 0) {
+            return 0;
+        }
+        for (size_t i = 0; i < n; i++) {
+            slots_[(tail + i) & mask_] = items[i];
+        }
+        tail_.store(tail + n, std::memory_order_release);
+        notEmpty_.notify();
+        return n;
+    }
+    
+    //! Consumer: pop one item if available
+    bool tryPop(T& out) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (usedSlots(head) == 0) {
+            return false;
+        }
+        out = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        notFull_.notify();
+        return true;
+    }
+    
+    //! Consumer: pop up to maxCount items into out, returns how many were taken
+    size_t tryPop(T* out, size_t maxCount) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t n = std::min(maxCount, usedSlots(head, maxCount));
+        if (n == 0) {
+            return 0;
+        }
+        for (size_t i = 0; i < n; i++) {
+            out[i] = std::move(slots_[(head + i) & mask_]);
+        }
+        head_.store(head + n, std::memory_order_release);
+        notFull_.notify();
+        return n;
+    }
+    
+    //! Producer: wait for room and push. Returns false if the queue was closed.
+    bool push(T item) {
+        for (;;) {
+            if (closed()) {
+                return false;
+            }
+            if (pushOne(std::move(item))) {
+                return true;
+            }
+            notFull_.waitUntil([&] { return hasSpace() || closed(); });
+        }
+    }
+    
+    //! Producer: push all items, waiting for room as needed. Returns how many were queued.
+    size_t push(const T* items, size_t count) {
+        size_t pushed = 0;
+        while (pushed < count && !closed()) {
+            pushed += tryPush(items + pushed, count - pushed);
+            if (pushed < count) {
+                notFull_.waitUntil([&] { return hasSpace() || closed(); });
+            }
+        }
+        return pushed;
+    }
+    
+    //! Consumer: wait for an item. Returns false once the queue is closed and drained.
+    bool pop(T& out) {
+        for (;;) {
+            if (tryPop(out)) {
+                return true;
+            }
+            if (closed()) {
+                return tryPop(out);
+            }
+            notEmpty_.waitUntil([&] { return hasItems() || closed(); });
+        }
+    }
+    
+    //! Consumer: wait for at least one item and take up to maxCount.
+    //! Returns 0 once the queue is closed and drained.
+    size_t pop(T* out, size_t maxCount) {
+        for (;;) {
+            if (size_t n = tryPop(out, maxCount)) {
+                return n;
+            }
+            if (closed()) {
+                return tryPop(out, maxCount);
+            }
+            notEmpty_.waitUntil([&] { return hasItems() || closed(); });
+        }
+    }
+    
+    //! Reject further pushes and wake blocked threads; queued items can still be popped
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        notEmpty_.notify();
+        notFull_.notify();
+    }
+    
+    bool closed() const {
+        return closed_.load(std::memory_order_acquire);
+    }
+    
+    //! Approximate number of queued items
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    //! Item is only moved from once a slot is secured, so callers can retry
+    template<typename U>
+    bool pushOne(U&& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (freeSlots(tail) == 0) {
+            return false;
+        }
+        slots_[tail & mask_] = std::forward<U>(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        notEmpty_.notify();
+        return true;
+    }
+    
+    //! Producer side; refreshes the cached head only when the ring looks too full
+    size_t freeSlots(size_t tail, size_t wanted = 1) {
+        size_t available = capacity_ - (tail - headCache_);
+        if (available < wanted) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            available = capacity_ - (tail - headCache_);
+        }
+        return available;
+    }
+    
+    //! Consumer side; refreshes the cached tail only when the ring looks too empty
+    size_t usedSlots(size_t head, size_t wanted = 1) {
+        size_t available = tailCache_ - head;
+        if (available < wanted) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            available = tailCache_ - head;
+        }
+        return available;
+    }
+    
+    bool hasSpace() const {
+        return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire) < capacity_;
+    }
+    
+    bool hasItems() const {
+        return tail_.load(std::memory_order_acquire) != head_.load(std::memory_order_relaxed);
+    }
+    
+    std::unique_ptr<T[]> slots_;
+    size_t capacity_;
+    size_t mask_;
+    std::atomic<bool> closed_{false};
+    
+    alignas(SERIALFLEX_CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    size_t tailCache_ = 0;  //! Consumer's last view of tail_
+    Wait notFull_;          //! Producer waits here, consumer notifies
+    
+    alignas(SERIALFLEX_CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+    size_t headCache_ = 0;  //! Producer's last view of head_
+    Wait notEmpty_;         //! Consumer waits here, producer notifies
+};
+
+//! Bounded lock-free multi-producer/single-consumer ring.
+//! Producers claim a run of slots with one CAS on the tail and publish each slot
+//! through its own sequence number; the consumer drains slots in order.
+//! A producer stalled between claiming and publishing holds back later items
+//! until it finishes, which is inherent to bounded ordered MPSC rings.
+template<typename T, typename Wait = YieldWait>
+class MpscQueue {
+    static_assert(std::is_default_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                  "Queue elements must be default constructible and nothrow movable");
+
+public:
+    explicit MpscQueue(size_t capacity)
+        : slots_(new Slot[detail::roundUpToPowerOfTwo(std::max<size_t>(capacity, 2))]),
+          capacity_(detail::roundUpToPowerOfTwo(std::max<size_t>(capacity, 2))), mask_(capacity_ - 1) {}
+    
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    
+    //! Any thread: push one item if there is room
+    bool tryPush(const T& item) {
+        return pushOne(item);
+    }
+    
+    bool tryPush(T&& item) {
+        return pushOne(std::move(item));
+    }
+    
+    //! Any thread: push up to count items as one contiguous run, returns how many were queued
+    size_t tryPush(const T* items, size_t count) {
+        size_t pos;
+        size_t n = claim(count, pos);
+        for (size_t i = 0; i < n; i++) {
+            Slot& slot = slots_[(pos + i) & mask_];
+            slot.value = items[i];
+            slot.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        if (n > 0) {
+            notEmpty_.notify();
+        }
+        return n;
+    }
+    
+    //! Consumer: pop one item if available
+    bool tryPop(T& out) {
+        return tryPop(&out, 1) == 1;
+    }
+    
+    //! Consumer: pop up to maxCount published items, returns how many were taken
+    size_t tryPop(T* out, size_t maxCount) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t n = 0;
+        while (n < maxCount) {
+            Slot& slot = slots_[(head + n) & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != head + n + 1) {
+                break;
+            }
+            out[n++] = std::move(slot.value);
+        }
+        if (n > 0) {
+            head_.store(head + n, std::memory_order_release);
+            notFull_.notify();
+        }
+        return n;
+    }
+    
+    //! Any thread: wait for room and push. Returns false if the queue was closed.
+    bool push(T item) {
+        for (;;) {
+            if (closed()) {
+                return false;
+            }
+            if (pushOne(std::move(item))) {
+                return true;
+            }
+            notFull_.waitUntil([&] { return hasSpace() || closed(); });
+        }
+    }
+    
+    //! Any thread: push all items, waiting for room as needed. Returns how many were queued.
+    size_t push(const T* items, size_t count) {
+        size_t pushed = 0;
+        while (pushed < count && !closed()) {
+            pushed += tryPush(items + pushed, count - pushed);
+            if (pushed < count) {
+                notFull_.waitUntil([&] { return hasSpace() || closed(); });
+            }
+        }
+        return pushed;
+    }
+    
+    //! Consumer: wait for an item. Returns false once the queue is closed and drained.
+    bool pop(T& out) {
+        return pop(&out, 1) == 1;
+    }
+    
+    //! Consumer: wait for at least one item and take up to maxCount.
+    //! Returns 0 once the queue is closed and drained.
+    size_t pop(T* out, size_t maxCount) {
+        for (;;) {
+            if (size_t n = tryPop(out, maxCount)) {
+                return n;
+            }
+            if (closed()) {
+                //! Producers that claimed slots before close() still publish them
+                notEmpty_.waitUntil([&] { return hasItems() || !hasClaimed(); });
+                return tryPop(out, maxCount);
+            }
+            notEmpty_.waitUntil([&] { return hasItems() || closed(); });
+        }
+    }
+    
+    //! Reject further pushes and wake blocked threads; queued items can still be popped
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        notEmpty_.notify();
+        notFull_.notify();
+    }
+    
+    bool closed() const {
+        return closed_.load(std::memory_order_acquire);
+    }
+    
+    //! Approximate number of claimed slots, including ones still being written
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0}; //! pos + 1 once the item for position pos is written
+        T value{};
+    };
+    
+    template<typename U>
+    bool pushOne(U&& item) {
+        size_t pos;
+        if (claim(1, pos) == 0) {
+            return false;
+        }
+        Slot& slot = slots_[pos & mask_];
+        slot.value = std::forward<U>(item);
+        slot.sequence.store(pos + 1, std::memory_order_release);
+        notEmpty_.notify();
+        return true;
+    }
+    
+    //! Reserve up to count consecutive slots; returns how many were claimed starting at pos
+    size_t claim(size_t count, size_t& pos) {
+        pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t used = pos - head_.load(std::memory_order_acquire);
+            if (used > capacity_) {
+                //! Our tail snapshot is older than the consumer's head
+                pos = tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+            size_t n = std::min(count, capacity_ - used);
+            if (n == 0) {
+                return 0;
+            }
+            if (tail_.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+                return n;
+            }
+        }
+    }
+    
+    bool hasSpace() const {
+        return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire) < capacity_;
+    }
+    
+    bool hasItems() const {
+        size_t head = head_.load(std::memory_order_relaxed);
+        return slots_[head & mask_].sequence.load(std::memory_order_acquire) == head + 1;
+    }
+    
+    bool hasClaimed() const {
+        return tail_.load(std::memory_order_acquire) != head_.load(std::memory_order_relaxed);
+    }
+    
+    std::unique_ptr<Slot[]> slots_;
+    size_t capacity_;
+    size_t mask_;
+    std::atomic<bool> closed_{false};
+    
+    alignas(SERIALFLEX_CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    Wait notFull_;  //! Producers wait here, consumer notifies
+    
+    alignas(SERIALFLEX_CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+    Wait notEmpty_; //! Consumer waits here, producers notify
+};
+
+//! Compact handle to a frame held in a FramePool; cheap to pass through a queue
+struct FrameDescriptor {
+    uint32_t buffer = 0;   //! Index of the pooled buffer holding the payload
+    uint16_t length = 0;   //! Payload length in bytes
+    uint8_t messageId = 0;
+};
+
+//! Fixed set of preallocated payload buffers handed between threads by FrameDescriptor.
+//! Buffers are acquired by one thread (typically the receive loop) and released from
+//! any thread, so moving a frame costs a memcpy and two queue operations, never an allocation.
+class FramePool {
+public:
+    FramePool(size_t bufferCount, size_t bufferSize = PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE)
+        : storage_(bufferCount * bufferSize), bufferSize_(bufferSize), freeList_(bufferCount) {
+        if (bufferCount == 0 || bufferCount > UINT32_MAX) {
+            throw std::invalid_argument("Frame pool needs between 1 and 2^32-1 buffers");
+        }
+        for (size_t i = 0; i < bufferCount; i++) {
+            freeList_.tryPush(static_cast<uint32_t>(i));
+        }
+    }
+    
+    //! Take a free buffer; acquiring thread only. Returns false if all buffers are in flight.
+    bool tryAcquire(uint32_t& handle) {
+        return freeList_.tryPop(handle);
+    }
+    
+    //! Return a buffer to the pool; safe from any thread
+    void release(uint32_t handle) {
+        freeList_.tryPush(handle); //! Never full: there are only bufferCount handles
+    }
+    
+    //! Copy a received packet into a pooled buffer; acquiring thread only.
+    //! Returns false if no buffer is free or the payload does not fit.
+    bool tryStore(const DeframedPacket& packet, FrameDescriptor& out) {
+        if (packet.payload.size() > bufferSize_ || !tryAcquire(out.buffer)) {
+            return false;
+        }
+        if (!packet.payload.empty()) {
+            std::memcpy(data(out.buffer), packet.payload.data(), packet.payload.size());
+        }
+        out.length = static_cast<uint16_t>(packet.payload.size());
+        out.messageId = packet.messageId;
+        return true;
+    }
+    
+    uint8_t* data(uint32_t handle) {
+        return storage_.data() + static_cast<size_t>(handle) * bufferSize_;
+    }
+    
+    //! Payload referenced by a descriptor, valid until its buffer is released
+    ByteSpan payload(const FrameDescriptor& frame) const {
+        return ByteSpan(storage_.data() + static_cast<size_t>(frame.buffer) * bufferSize_, frame.length);
+    }
+    
+    size_t bufferSize() const {
+        return bufferSize_;
+    }
+
+private:
+    std::vector<uint8_t> storage_;
+    size_t bufferSize_;
+    MpscQueue<uint32_t> freeList_;
+};
+
+} //! namespace serialflex
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "serialflex.hpp"
+#include <chrono>
+
+namespace serialflex {
+
+//! --------------------------------
+//! TRANSMIT SCHEDULING
+//! --------------------------------
+
+//! One queue of a TransmitScheduler
+struct TrafficClass {
+    using Duration = std::chrono::microseconds;
+
+    unsigned weight = 1;                   //! Share of the line against other non-urgent classes
+    Duration latencyBudget{0};             //! How long a message may wait to be coalesced; zero = urgent
+    size_t maxQueuedBytes = 64 * 1024;     //! Framed bytes this class may hold; enqueue() refuses beyond
+};
+
+//! Settings of a TransmitScheduler
+struct SchedulerConfig {
+    size_t maxBatchBytes = 512;            //! Largest single write
+    uint32_t lineRate = 0;                 //! Bytes per second of the link; zero disables pacing
+};
+
+//! Priority-aware transmit scheduler in front of the framer.
+//!
+//! Messages are framed into per-class queues. Queued frames go out back to back in
+//! one writer(ByteSpan) call, the batch, rather than in one write each.
+//!  - Urgent classes (latencyBudget zero) are written at once. They lead every
+//!    batch, in class order.
+//!  - Other classes wait until the oldest queued frame has used up its budget,
+//!    or until a full batch has accumulated, like Nagle's algorithm. They share
+//!    what is left of each batch by deficit round robin, in proportion to weight.
+//!
+//! With lineRate set, the scheduler keeps at most one batch on the wire: the next
+//! batch is only written once the previous one would have left the line. Bulk
+//! traffic waits here rather than in a kernel or UART buffer, so an urgent frame
+//! never waits behind more than one batch. Without pacing, every due batch is
+//! written at once.
+//!
+//! Like the other link layers it reads no clock and has no thread. Every call
+//! takes `now`, and nextDeadline() says when tick() is due.
+template<typename Writer>
+class TransmitScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    struct Stats {
+        uint64_t writes = 0;
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t refused = 0;          //! enqueue() calls rejected by a full class queue
+    };
+
+    TransmitScheduler(Writer writer, std::vector<TrafficClass> classes, SchedulerConfig config = SchedulerConfig())
+        : writer_(std::move(writer)), config_(config) {
+        if (classes.empty()) {
+            throw std::invalid_argument("Scheduler needs at least one traffic class");
+        }
+        queues_.resize(classes.size());
+        for (size_t i = 0; i < classes.size(); i++) {
+            if (classes[i].weight == 0) {
+                throw std::invalid_argument("Traffic class weight must be positive");
+            }
+            queues_[i].traffic = classes[i];
+        }
+        batch_.reserve(config.maxBatchBytes);
+    }
+
+    //! Frame a message into its class queue and write whatever is due. Returns
+    //! false, and queues nothing, when the frame would take the class past
+    //! maxQueuedBytes. An empty class always takes one frame.
+    bool enqueue(size_t trafficClass, uint8_t messageId, ByteSpan payload, TimePoint now) {
+        Queue& queue = queues_.at(trafficClass);
+        size_t start = queue.bytes.size();
+        PacketFramer::appendPacket(queue.bytes, messageId, payload);
+        size_t size = queue.bytes.size() - start;
+        if (queue.queuedBytes() > queue.traffic.maxQueuedBytes && !queue.frames.empty()) {
+            queue.bytes.resize(start);
+            stats_.refused++;
+            return false;
+        }
+
+        queue.frames.push_back({size, now});
+        queuedBytes_ += size;
+
+        tick(now);
+        return true;
+    }
+
+    //! Serialize and enqueue a message
+    template<typename T>
+    bool enqueueMessage(size_t trafficClass, uint8_t messageId, const T& data, TimePoint now) {
+        return enqueue(trafficClass, messageId, ByteSpan(serialize(data)), now);
+    }
+
+    //! Write the batches that are due
+    void tick(TimePoint now) {
+        while (queuedBytes_ > 0 && now >= wireFreeAt_ && due(now)) {
+            writeBatch(now);
+        }
+    }
+
+    //! Write everything queued now, ignoring budgets and pacing (e.g. before closing)
+    void flush(TimePoint now) {
+        while (queuedBytes_ > 0) {
+            writeBatch(now);
+        }
+    }
+
+    //! When tick() next has work to do; TimePoint::max() when nothing is queued
+    TimePoint nextDeadline() const {
+        if (queuedBytes_ == 0) {
+            return TimePoint::max();
+        }
+        TimePoint ready = TimePoint::max();
+        if (queuedBytes_ >= config_.maxBatchBytes) {
+            ready = TimePoint::min();
+        }
+        for (const Queue& queue : queues_) {
+            if (!queue.frames.empty()) {
+                ready = std::min(ready, queue.frames.front().enqueued + queue.traffic.latencyBudget);
+            }
+        }
+        return std::max(ready, wireFreeAt_);
+    }
+
+    //! Framed bytes waiting in all queues
+    size_t queuedBytes() const {
+        return queuedBytes_;
+    }
+
+    //! Framed bytes waiting in one class
+    size_t queuedBytes(size_t trafficClass) const {
+        return queues_.at(trafficClass).queuedBytes();
+    }
+
+    const Stats& stats() const {
+        return stats_;
+    }
+
+private:
+    //! Deficit round robin hands each class weight * QUANTUM bytes per round
+    static constexpr size_t QUANTUM = 64;
+
+    struct Pending {
+        size_t size;
+        TimePoint enqueued;
+    };
+
+    struct Queue {
+        TrafficClass traffic;
+        std::vector<uint8_t> bytes;    //! Frames back to back; [head, end) still queued
+        size_t head = 0;
+        std::deque<Pending> frames;
+        size_t deficit = 0;
+
+        size_t queuedBytes() const {
+            return bytes.size() - head;
+        }
+    };
+
+    //! A batch is due when an urgent frame or a full batch waits, or a budget ran out
+    bool due(TimePoint now) const {
+        if (queuedBytes_ >= config_.maxBatchBytes) {
+            return true;
+        }
+        for (const Queue& queue : queues_) {
+            if (!queue.frames.empty() && now >= queue.frames.front().enqueued + queue.traffic.latencyBudget) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void writeBatch(TimePoint now) {
+        batch_.clear();
+
+        //! Urgent classes first, in order
+        for (Queue& queue : queues_) {
+            if (queue.traffic.latencyBudget.count() == 0) {
+                while (!queue.frames.empty() && fits(queue.frames.front().size)) {
+                    take(queue);
+                }
+            }
+        }
+
+        //! Then deficit round robin over the rest while any of them has a frame that fits
+        for (bool eligible = true; eligible;) {
+            eligible = false;
+            for (Queue& queue : queues_) {
+                if (queue.traffic.latencyBudget.count() == 0 || queue.frames.empty() ||
+                    !fits(queue.frames.front().size)) {
+                    continue;
+                }
+                eligible = true;
+                queue.deficit += queue.traffic.weight * QUANTUM;
+                while (!queue.frames.empty() && queue.frames.front().size <= queue.deficit &&
+                       fits(queue.frames.front().size)) {
+                    queue.deficit -= queue.frames.front().size;
+                    take(queue);
+                }
+                if (queue.frames.empty()) {
+                    queue.deficit = 0; //! An idle class does not bank credit
+                }
+            }
+        }
+
+        writer_(ByteSpan(batch_));
+        stats_.writes++;
+        stats_.bytes += batch_.size();
+        if (config_.lineRate > 0) {
+            wireFreeAt_ = std::max(wireFreeAt_, now) + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(static_cast<double>(batch_.size()) / config_.lineRate));
+        }
+    }
+
+    //! A frame larger than a whole batch still goes out, alone
+    bool fits(size_t size) const {
+        return batch_.empty() || batch_.size() + size <= config_.maxBatchBytes;
+    }
+
+    //! Move the oldest frame of a queue into the batch
+    void take(Queue& queue) {
+        size_t size = queue.frames.front().size;
+        batch_.insert(batch_.end(), queue.bytes.begin() + queue.head, queue.bytes.begin() + queue.head + size);
+        queue.head += size;
+        queue.frames.pop_front();
+        queuedBytes_ -= size;
+        stats_.frames++;
+
+        //! Reclaim consumed space once it dominates the buffer
+        if (queue.head == queue.bytes.size()) {
+            queue.bytes.clear();
+            queue.head = 0;
+        } else if (queue.head > queue.bytes.size() / 2) {
+            queue.bytes.erase(queue.bytes.begin(), queue.bytes.begin() + queue.head);
+            queue.head = 0;
+        }
+    }
+
+    Writer writer_;
+    SchedulerConfig config_;
+    std::vector<Queue> queues_;
+    std::vector<uint8_t> batch_;
+    size_t queuedBytes_ = 0;
+    TimePoint wireFreeAt_{};
+    Stats stats_;
+};
+
+} //! namespace serialflex
@@ -0,0 +1,439 @@
+#pragma once
+
+#include "serialflex.hpp"
+#include "serialflex_queue.hpp"
+#include "serialflex_transport.hpp"
+#include <chrono>
+#include <new>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <utility>
+
+namespace serialflex {
+
+//! --------------------------------
+//! SHARED-MEMORY TRANSPORT
+//! --------------------------------
+
+namespace detail {
+    //! Process-shared futex (no _PRIVATE flag): the word lives in a shared mapping
+    inline void sharedFutexWait(std::atomic<uint32_t>& word, uint32_t expected, int timeoutMs) {
+        timespec timeout{};
+        timespec* timeoutPtr = nullptr;
+        if (timeoutMs >= 0) {
+            timeout.tv_sec = timeoutMs / 1000;
+            timeout.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000;
+            timeoutPtr = &timeout;
+        }
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, timeoutPtr, nullptr, 0);
+    }
+    
+    inline void sharedFutexWake(std::atomic<uint32_t>& word) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+    
+    //! Control block at the start of the mapping; the record area follows it
+    struct ShmRingHeader {
+        std::atomic<uint32_t> magic;
+        uint32_t version;
+        uint64_t capacity;
+        
+        alignas(SERIALFLEX_CACHE_LINE_SIZE) std::atomic<uint64_t> head; //! Written by the reader only
+        std::atomic<uint32_t> spaceSignal;                                //! Futex word the writer sleeps on
+        std::atomic<uint32_t> writerWaiting;
+        
+        alignas(SERIALFLEX_CACHE_LINE_SIZE) std::atomic<uint64_t> tail; //! Written by the writer only
+        std::atomic<uint32_t> dataSignal;                                 //! Futex word the reader sleeps on
+        std::atomic<uint32_t> readerWaiting;
+    };
+    
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                  "Shared-memory ring needs address-free atomics");
+    
+    //! Every record starts 8-byte aligned with this header
+    struct ShmRecordHeader {
+        uint32_t size;       //! Bytes following the header (before alignment padding)
+        uint8_t kind;
+        uint8_t messageId;
+        uint16_t reserved;
+    };
+}
+
+//! A record handed to ShmRing::read(). payload points into the shared mapping (or,
+//! for stuffed frames, into the reader's scratch buffer) and is valid only during
+//! the handler call; decode it in place with deserialize<T>(payload) or dispatch().
+struct ShmMessage {
+    uint8_t messageId = 0;
+    ByteSpan payload;
+    FrameStatus status = FrameStatus::Ok; //! Always Ok for records written with write()
+    
+    bool valid() const {
+        return status == FrameStatus::Ok;
+    }
+};
+
+//! Single-producer/single-consumer message ring in shared memory, for processes on
+//! one host. One process writes, one process reads; use two rings for a duplex link.
+//!
+//! Records are [size, kind, messageId] + payload, 8-byte aligned and never split
+//! across the end of the ring, so a reader hands out each payload as one contiguous
+//! span of the mapping with no copy. write() stores a raw serialized payload;
+//! writeFrame() stores framed bytes as received from a wire, validated on read.
+//!
+//! Each side spins briefly on the other's index and then sleeps on a process-shared
+//! futex. A wake-up system call is made only while the other side is asleep, so a
+//! busy ring moves messages with two cache-line transfers and no system calls.
+class ShmRing {
+public:
+    static constexpr uint32_t MAGIC = 0x53465252; //! "SFRR"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t DEFAULT_CAPACITY = 1024 * 1024;
+    
+    //! Polls of the other side's index before sleeping in the kernel (multi-core hosts)
+    static constexpr int SPIN_LIMIT = 2048;
+    
+    //! Create a named ring (shm_open), failing if the name exists
+    static ShmRing create(const std::string& name, size_t capacity = DEFAULT_CAPACITY) {
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            detail::throwSystemError("shm_open");
+        }
+        size_t roundedCapacity = ringCapacity(capacity);
+        if (::ftruncate(fd, static_cast<off_t>(sizeof(detail::ShmRingHeader) + roundedCapacity)) != 0) {
+            int error = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            errno = error;
+            detail::throwSystemError("ftruncate");
+        }
+        return ShmRing(fd, roundedCapacity, true);
+    }
+    
+    //! Map a ring created by another process
+    static ShmRing open(const std::string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0) {
+            detail::throwSystemError("shm_open");
+        }
+        struct stat info{};
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) <= sizeof(detail::ShmRingHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Not a SerialFlex shared-memory ring");
+        }
+        return ShmRing(fd, static_cast<size_t>(info.st_size) - sizeof(detail::ShmRingHeader), false);
+    }
+    
+    //! Remove a named ring; processes that mapped it keep their mapping
+    static void unlink(const std::string& name) {
+        ::shm_unlink(name.c_str());
+    }
+    
+    //! Unnamed ring shared with child processes created by fork()
+    static ShmRing anonymous(size_t capacity = DEFAULT_CAPACITY) {
+        return ShmRing(-1, ringCapacity(capacity), true);
+    }
+    
+    ShmRing(ShmRing&& other) noexcept
+        : header_(std::exchange(other.header_, nullptr)), data_(other.data_), capacity_(other.capacity_),
+          mask_(other.mask_), cachedHead_(other.cachedHead_), cachedTail_(other.cachedTail_),
+          scratch_(std::move(other.scratch_)) {}
+    
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+    ShmRing& operator=(ShmRing&&) = delete;
+    
+    ~ShmRing() {
+        if (header_ != nullptr) {
+            ::munmap(header_, sizeof(detail::ShmRingHeader) + capacity_);
+        }
+    }
+    
+    //! Copy a serialized payload into the ring, waiting up to timeoutMs (-1 = forever)
+    //! for space. Returns false on timeout.
+    bool write(uint8_t messageId, ByteSpan payload, int timeoutMs = -1) {
+        return put(RecordKind::Message, messageId, payload, timeoutMs);
+    }
+    
+    //! Serialize and write a message
+    template<typename T>
+    bool writeMessage(uint8_t messageId, const T& data, int timeoutMs = -1) {
+        return write(messageId, ByteSpan(serialize(data)), timeoutMs);
+    }
+    
+    //! Write framed bytes (START..END) as they came off a wire; the reader validates them
+    bool writeFrame(ByteSpan frame, int timeoutMs = -1) {
+        return put(RecordKind::Frame, 0, frame, timeoutMs);
+    }
+    
+    //! Write without waiting; false when the ring is full
+    bool tryWrite(uint8_t messageId, ByteSpan payload) {
+        return write(messageId, payload, 0);
+    }
+    
+    //! Wait up to timeoutMs (-1 = forever, 0 = don't block) for records, then pass
+    //! every record available to handler(const ShmMessage&) in order. Each record is
+    //! released to the writer once its handler returns; a handler that throws leaves
+    //! its record unread. Returns the number of records handled.
+    template<typename Handler>
+    size_t read(Handler&& handler, int timeoutMs = -1) {
+        uint64_t head = header_->head.load(std::memory_order_relaxed);
+        if (!waitForData(head, timeoutMs)) {
+            return 0;
+        }
+        
+        size_t handled = 0;
+        uint64_t tail = cachedTail_;
+        while (head != tail) {
+            size_t offset = static_cast<size_t>(head & mask_);
+            detail::ShmRecordHeader record;
+            std::memcpy(&record, data_ + offset, sizeof(record));
+            
+            if (record.kind == static_cast<uint8_t>(RecordKind::Wrap)) {
+                head += capacity_ - offset;
+            } else {
+                if (record.size > capacity_ - offset - sizeof(record) ||
+                    (record.kind != static_cast<uint8_t>(RecordKind::Message) &&
+                     record.kind != static_cast<uint8_t>(RecordKind::Frame))) {
+                    throw std::runtime_error("Corrupt shared-memory ring record");
+                }
+                deliver(record, ByteSpan(data_ + offset + sizeof(record), record.size), handler);
+                head += recordSize(record.size);
+                handled++;
+            }
+            releaseTo(head);
+        }
+        return handled;
+    }
+    
+    //! Read without waiting
+    template<typename Handler>
+    size_t tryRead(Handler&& handler) {
+        return read(std::forward<Handler>(handler), 0);
+    }
+    
+    //! Bytes of record area (excluding the control block)
+    size_t capacity() const {
+        return capacity_;
+    }
+    
+    //! Largest payload a single record can carry
+    size_t maxPayloadSize() const {
+        return capacity_ - sizeof(detail::ShmRecordHeader);
+    }
+    
+    //! Bytes written and not yet read, including record headers and padding
+    size_t usedBytes() const {
+        return static_cast<size_t>(header_->tail.load(std::memory_order_acquire) -
+                                   header_->head.load(std::memory_order_acquire));
+    }
+
+private:
+    enum class RecordKind : uint8_t {
+        Message = 1,
+        Frame = 2,
+        Wrap = 3    //! Padding up to the end of the ring; the next record starts at offset 0
+    };
+    
+    static size_t ringCapacity(size_t capacity) {
+        if (capacity < 4096 || capacity > (size_t(1) << 40)) {
+            throw std::invalid_argument("Shared-memory ring capacity out of range");
+        }
+        return detail::roundUpToPowerOfTwo(capacity);
+    }
+    
+    static uint64_t recordSize(size_t payloadSize) {
+        return (sizeof(detail::ShmRecordHeader) + payloadSize + 7) & ~uint64_t(7);
+    }
+    
+    //! Map fd (or anonymous shared memory when fd < 0); with initialize, set up the
+    //! control block and publish the magic last so openers never see half a header
+    ShmRing(int fd, size_t capacity, bool initialize) : capacity_(capacity), mask_(capacity - 1) {
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            throw std::runtime_error("Not a SerialFlex shared-memory ring");
+        }
+        
+        size_t mappedSize = sizeof(detail::ShmRingHeader) + capacity;
+        int flags = fd < 0 ? MAP_SHARED | MAP_ANONYMOUS : MAP_SHARED;
+        void* mapping = ::mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, flags, fd, 0);
+        int error = errno;
+        if (fd >= 0) {
+            ::close(fd); //! The mapping keeps the memory alive
+        }
+        if (mapping == MAP_FAILED) {
+            errno = error;
+            detail::throwSystemError("mmap");
+        }
+        header_ = static_cast<detail::ShmRingHeader*>(mapping);
+        data_ = static_cast<uint8_t*>(mapping) + sizeof(detail::ShmRingHeader);
+        
+        if (initialize) {
+            new (header_) detail::ShmRingHeader();
+            header_->version = VERSION;
+            header_->capacity = capacity;
+            header_->magic.store(MAGIC, std::memory_order_release);
+        } else if (header_->magic.load(std::memory_order_acquire) != MAGIC || header_->version != VERSION ||
+                   header_->capacity != capacity) {
+            ::munmap(mapping, mappedSize);
+            header_ = nullptr;
+            throw std::runtime_error("Not a SerialFlex shared-memory ring");
+        }
+        cachedHead_ = header_->head.load(std::memory_order_acquire);
+        cachedTail_ = header_->tail.load(std::memory_order_acquire);
+    }
+    
+    bool put(RecordKind kind, uint8_t messageId, ByteSpan payload, int timeoutMs) {
+        if (payload.size() > maxPayloadSize()) {
+            throw std::length_error("Record exceeds shared-memory ring capacity");
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeoutMs, 0));
+        uint64_t size = recordSize(payload.size());
+        uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+        size_t offset = static_cast<size_t>(tail & mask_);
+        
+        //! Records never wrap: pad out the rest of the ring and start again at offset 0
+        if (size > capacity_ - offset) {
+            uint64_t padding = capacity_ - offset;
+            if (!waitForSpace(tail, padding, timeoutMs, deadline)) {
+                return false;
+            }
+            detail::ShmRecordHeader wrap{static_cast<uint32_t>(padding), static_cast<uint8_t>(RecordKind::Wrap), 0, 0};
+            std::memcpy(data_ + offset, &wrap, sizeof(wrap));
+            tail += padding;
+            publishTo(tail);
+            offset = 0;
+        }
+        if (!waitForSpace(tail, size, timeoutMs, deadline)) {
+            return false;
+        }
+        
+        detail::ShmRecordHeader record{static_cast<uint32_t>(payload.size()), static_cast<uint8_t>(kind), messageId, 0};
+        std::memcpy(data_ + offset, &record, sizeof(record));
+        if (!payload.empty()) {
+            std::memcpy(data_ + offset + sizeof(record), payload.data(), payload.size());
+        }
+        publishTo(tail + size);
+        return true;
+    }
+    
+    template<typename Handler>
+    void deliver(const detail::ShmRecordHeader& record, ByteSpan bytes, Handler& handler) {
+        ShmMessage message;
+        if (record.kind == static_cast<uint8_t>(RecordKind::Message)) {
+            message.messageId = record.messageId;
+            message.payload = bytes;
+        } else {
+            FrameView view = PacketFramer::validateFrame(bytes);
+            message.messageId = view.messageId;
+            message.status = view.status;
+            if (view.valid() && view.stuffed()) {
+                PacketFramer::unstuffPayload(view, scratch_);
+                message.payload = ByteSpan(scratch_);
+            } else if (view.valid()) {
+                message.payload = view.payload;
+            }
+        }
+        handler(static_cast<const ShmMessage&>(message));
+    }
+    
+    //! Writer: make the new tail visible, waking the reader only if it sleeps
+    void publishTo(uint64_t tail) {
+        header_->tail.store(tail, std::memory_order_release);
+        //! Pairs with the fence in waitForData(): either the reader sees the tail or we see it waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (header_->readerWaiting.load(std::memory_order_relaxed) != 0) {
+            header_->dataSignal.fetch_add(1, std::memory_order_release);
+            detail::sharedFutexWake(header_->dataSignal);
+        }
+    }
+    
+    //! Reader: hand consumed space back, waking the writer only if it sleeps
+    void releaseTo(uint64_t head) {
+        header_->head.store(head, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (header_->writerWaiting.load(std::memory_order_relaxed) != 0) {
+            header_->spaceSignal.fetch_add(1, std::memory_order_release);
+            detail::sharedFutexWake(header_->spaceSignal);
+        }
+    }
+    
+    bool waitForSpace(uint64_t tail, uint64_t bytes, int timeoutMs,
+                      std::chrono::steady_clock::time_point deadline) {
+        auto hasSpace = [&] {
+            if (capacity_ - (tail - cachedHead_) >= bytes) {
+                return true;
+            }
+            cachedHead_ = header_->head.load(std::memory_order_acquire);
+            return capacity_ - (tail - cachedHead_) >= bytes;
+        };
+        return waitUntil(hasSpace, header_->spaceSignal, header_->writerWaiting, timeoutMs, deadline);
+    }
+    
+    bool waitForData(uint64_t head, int timeoutMs) {
+        auto hasData = [&] {
+            if (cachedTail_ != head) {
+                return true;
+            }
+            cachedTail_ = header_->tail.load(std::memory_order_acquire);
+            return cachedTail_ != head;
+        };
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeoutMs, 0));
+        return waitUntil(hasData, header_->dataSignal, header_->readerWaiting, timeoutMs, deadline);
+    }
+    
+    //! Spin, then sleep on signal with waiting raised until ready() or the deadline
+    template<typename Ready>
+    bool waitUntil(Ready& ready, std::atomic<uint32_t>& signal, std::atomic<uint32_t>& waiting,
+                   int timeoutMs, std::chrono::steady_clock::time_point deadline) {
+        //! On a single CPU the other side cannot make progress while we spin
+        static const int spinLimit = std::thread::hardware_concurrency() > 1 ? SPIN_LIMIT : 1;
+        for (int i = 0; i < spinLimit; i++) {
+            if (ready()) {
+                return true;
+            }
+            if (timeoutMs == 0) {
+                return false;
+            }
+            detail::cpuRelax();
+        }
+        
+        for (;;) {
+            int remainingMs = -1;
+            if (timeoutMs >= 0) {
+                auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                if (remaining.count() <= 0) {
+                    return ready();
+                }
+                remainingMs = static_cast<int>(remaining.count());
+            }
+            
+            uint32_t epoch = signal.load(std::memory_order_acquire);
+            waiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool isReady = ready();
+            if (!isReady) {
+                detail::sharedFutexWait(signal, epoch, remainingMs);
+                isReady = ready();
+            }
+            waiting.store(0, std::memory_order_relaxed);
+            if (isReady) {
+                return true;
+            }
+        }
+    }
+    
+    detail::ShmRingHeader* header_ = nullptr;
+    uint8_t* data_ = nullptr;
+    size_t capacity_;
+    size_t mask_;
+    uint64_t cachedHead_ = 0;   //! Writer's last view of head
+    uint64_t cachedTail_ = 0;   //! Reader's last view of tail
+    PayloadBuffer scratch_;     //! Unstuffed payloads of framed records
+};
+
+} //! namespace serialflex
@@ -0,0 +1,355 @@
+#pragma once
+
+#include "serialflex.hpp"
+#include <chrono>
+#include <cmath>
+
+namespace serialflex {
+
+//! --------------------------------
+//! LINK SIMULATION
+//! --------------------------------
+
+namespace detail {
+
+//! SplitMix64: tiny, fast, and identical on every platform and standard library,
+//! unlike the std:: distributions, so a seed replays the same run everywhere
+class SimRandom {
+public:
+    explicit SimRandom(uint64_t seed) : state_(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    //! Uniform in [0, 1)
+    double uniform() {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    bool chance(double probability) {
+        return probability > 0 && uniform() < probability;
+    }
+
+    //! Trials before the next success, for skipping ahead between rare events
+    uint64_t gap(double probability) {
+        if (probability <= 0) {
+            return UINT64_MAX;
+        }
+        if (probability >= 1) {
+            return 0;
+        }
+        double trials = std::floor(std::log1p(-uniform()) / std::log1p(-probability));
+        return trials >= 1.8e19 ? UINT64_MAX : static_cast<uint64_t>(trials);
+    }
+
+private:
+    uint64_t state_;
+};
+
+} //! namespace detail
+
+//! Impairments of one direction of a simulated serial link
+struct LinkModel {
+    using Duration = std::chrono::nanoseconds;
+
+    uint32_t baudRate = 115200;        //! Line rate; every byte costs 10 bits (8N1)
+    Duration latency{0};               //! Propagation and modem delay, added to every write
+    double bitErrorRate = 0;           //! Independent bit flips outside bursts
+    double burstRate = 0;              //! Chance per byte that an error burst starts
+    double burstLength = 16;           //! Mean burst length in bytes
+    double burstBitErrorRate = 0.5;    //! Chance per bit of a flip inside a burst
+    double byteDropRate = 0;           //! Bytes lost outright, e.g. UART overruns
+    double duplicateRate = 0;          //! Writes delivered twice, as by a retrying modem
+    uint64_t seed = 1;
+};
+
+//! One direction of a link: bytes written at virtual time t leave the transmitter
+//! one byte time after another, pick up errors, and arrive `latency` later. Each
+//! write arrives as one chunk when its last byte lands, in order.
+class SimulatedChannel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    struct Stats {
+        uint64_t bytesWritten = 0;
+        uint64_t bytesDelivered = 0;
+        uint64_t bitsFlipped = 0;
+        uint64_t bytesDropped = 0;
+        uint64_t bursts = 0;
+        uint64_t duplicatedWrites = 0;
+    };
+
+    explicit SimulatedChannel(const LinkModel& model)
+        : model_(model), random_(model.seed),
+          byteTime_(std::chrono::nanoseconds(10'000'000'000ll / std::max<uint32_t>(model.baudRate, 1))) {
+        nextBitError_ = random_.gap(model.bitErrorRate);
+    }
+
+    //! Queue bytes behind anything still being transmitted
+    void write(ByteSpan bytes, TimePoint now) {
+        if (bytes.empty()) {
+            return;
+        }
+        stats_.bytesWritten += bytes.size();
+        int copies = random_.chance(model_.duplicateRate) ? 2 : 1;
+        stats_.duplicatedWrites += copies - 1;
+
+        for (int copy = 0; copy < copies; copy++) {
+            busyUntil_ = std::max(busyUntil_, now) + byteTime_ * static_cast<int64_t>(bytes.size());
+            Segment segment;
+            segment.arrival = busyUntil_ + model_.latency;
+            segment.bytes.reserve(bytes.size());
+            for (uint8_t byte : bytes) {
+                if (random_.chance(model_.byteDropRate)) {
+                    stats_.bytesDropped++;
+                    continue;
+                }
+                segment.bytes.push_back(impair(byte));
+            }
+            inFlight_.push_back(std::move(segment));
+        }
+    }
+
+    //! Arrival time of the next chunk; TimePoint::max() when nothing is in flight
+    TimePoint nextArrival() const {
+        return inFlight_.empty() ? TimePoint::max() : inFlight_.front().arrival;
+    }
+
+    //! Pass every chunk that arrived by `now` to sink(ByteSpan)
+    template<typename Sink>
+    void deliver(TimePoint now, Sink&& sink) {
+        while (!inFlight_.empty() && inFlight_.front().arrival <= now) {
+            Segment segment = std::move(inFlight_.front());
+            inFlight_.pop_front();
+            stats_.bytesDelivered += segment.bytes.size();
+            sink(ByteSpan(segment.bytes));
+        }
+    }
+
+    //! When the transmitter finishes sending what has been written so far
+    TimePoint busyUntil() const {
+        return busyUntil_;
+    }
+
+    //! Time one byte occupies the line
+    std::chrono::nanoseconds byteTime() const {
+        return byteTime_;
+    }
+
+    const LinkModel& model() const {
+        return model_;
+    }
+
+    const Stats& stats() const {
+        return stats_;
+    }
+
+private:
+    struct Segment {
+        TimePoint arrival;
+        std::vector<uint8_t> bytes;
+    };
+
+    //! Gilbert-Elliott style: rare independent flips, plus bursts of dense errors
+    uint8_t impair(uint8_t byte) {
+        if (inBurst_) {
+            inBurst_ = !random_.chance(1.0 / std::max(model_.burstLength, 1.0));
+        } else if (random_.chance(model_.burstRate)) {
+            inBurst_ = true;
+            stats_.bursts++;
+        }
+
+        for (int bit = 0; bit < 8; bit++) {
+            bool flip = inBurst_ && random_.chance(model_.burstBitErrorRate);
+            if (nextBitError_-- == 0) {
+                flip = true;
+                nextBitError_ = random_.gap(model_.bitErrorRate);
+            }
+            if (flip) {
+                byte ^= static_cast<uint8_t>(1u << bit);
+                stats_.bitsFlipped++;
+            }
+        }
+        return byte;
+    }
+
+    LinkModel model_;
+    detail::SimRandom random_;
+    std::chrono::nanoseconds byteTime_;
+    uint64_t nextBitError_ = 0;
+    bool inBurst_ = false;
+    TimePoint busyUntil_{};
+    std::deque<Segment> inFlight_;
+    Stats stats_;
+};
+
+enum class LinkSide : uint8_t {
+    A,
+    B
+};
+
+//! Two SerialFlex endpoints joined by a simulated link, on a virtual clock that
+//! starts at zero. Whatever an endpoint writes is framed as on a real wire and
+//! parsed byte by byte by a PacketReceiver on the other side. Runs depend only
+//! on the models and seeds, and take no wall-clock time.
+//!
+//! Drive it with step(): it moves the clock to the next arrival, or to `limit`
+//! if that comes first (pass the next protocol timer), and reports each packet,
+//! corrupted ones included, to onPacket(LinkSide receiver, DeframedPacket&).
+class LinkSimulator {
+public:
+    using Clock = SimulatedChannel::Clock;
+    using TimePoint = SimulatedChannel::TimePoint;
+
+    LinkSimulator(const LinkModel& aToB, const LinkModel& bToA,
+                  size_t maxPayloadSize = PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE)
+        : channels_{SimulatedChannel(aToB), SimulatedChannel(bToA)},
+          receivers_{PacketReceiver(maxPayloadSize), PacketReceiver(maxPayloadSize)} {}
+
+    //! The same impairments both ways, with independent error patterns
+    explicit LinkSimulator(const LinkModel& model, size_t maxPayloadSize = PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE)
+        : LinkSimulator(model, reseeded(model), maxPayloadSize) {}
+
+    TimePoint now() const {
+        return now_;
+    }
+
+    //! Write raw bytes (normally whole frames) from one side at the current time
+    void write(LinkSide from, ByteSpan bytes) {
+        channel(from).write(bytes, now_);
+    }
+
+    //! Serialize, frame and write a message
+    template<typename T>
+    void send(LinkSide from, uint8_t messageId, const T& data) {
+        std::vector<uint8_t> packet = createPacket(messageId, data);
+        write(from, ByteSpan(packet));
+    }
+
+    //! Advance to the next arrival, or to limit if nothing arrives earlier. Returns
+    //! false if the clock reached limit (or nothing is in flight and limit is max).
+    template<typename OnPacket>
+    bool step(TimePoint limit, OnPacket&& onPacket) {
+        TimePoint next = std::min(channels_[0].nextArrival(), channels_[1].nextArrival());
+        if (next > limit || next == TimePoint::max()) {
+            if (limit != TimePoint::max()) {
+                now_ = std::max(now_, limit);
+            }
+            return false;
+        }
+
+        now_ = std::max(now_, next);
+        for (LinkSide to : {LinkSide::B, LinkSide::A}) {
+            PacketReceiver& receiver = this->receiver(to);
+            channel(to == LinkSide::A ? LinkSide::B : LinkSide::A).deliver(now_, [&](ByteSpan bytes) {
+                for (uint8_t byte : bytes) {
+                    if (receiver.processByte(byte, packet_)) {
+                        onPacket(to, packet_);
+                    }
+                }
+            });
+        }
+        return true;
+    }
+
+    //! Deliver everything that arrives up to limit, then leave the clock there
+    template<typename OnPacket>
+    void runUntil(TimePoint limit, OnPacket&& onPacket) {
+        while (step(limit, onPacket)) {}
+    }
+
+    //! Deliver everything still in flight
+    template<typename OnPacket>
+    void drain(OnPacket&& onPacket) {
+        while (step(TimePoint::max(), onPacket)) {}
+    }
+
+    //! The direction carrying bytes written by `from`
+    SimulatedChannel& channel(LinkSide from) {
+        return channels_[static_cast<size_t>(from)];
+    }
+
+    //! The receiver parsing bytes arriving at `side`
+    PacketReceiver& receiver(LinkSide side) {
+        return receivers_[static_cast<size_t>(side)];
+    }
+
+private:
+    static LinkModel reseeded(LinkModel model) {
+        model.seed = detail::SimRandom(model.seed).next();
+        return model;
+    }
+
+    SimulatedChannel channels_[2];
+    PacketReceiver receivers_[2];
+    DeframedPacket packet_;
+    TimePoint now_{};
+};
+
+//! Goodput, loss and latency of messages sent across a simulated link
+struct LinkReport {
+    using Duration = std::chrono::nanoseconds;
+
+    uint64_t messagesSent = 0;
+    uint64_t messagesDelivered = 0;
+    double lossRate = 0;               //! Fraction of sent messages never delivered intact
+    double goodputBitsPerSecond = 0;   //! Payload bits delivered per second of virtual time
+    Duration latencyP50{0};
+    Duration latencyP90{0};
+    Duration latencyP99{0};
+    Duration latencyMax{0};
+};
+
+//! Collects per-message outcomes for a LinkReport. Sent messages are counted
+//! with sent(); delivered ones with delivered(), which also records the latency.
+//! Deduplicate before calling delivered() if the protocol can deliver twice.
+class LinkMeter {
+public:
+    using TimePoint = SimulatedChannel::TimePoint;
+
+    void sent(size_t count = 1) {
+        sent_ += count;
+    }
+
+    void delivered(size_t payloadBytes, TimePoint sentAt, TimePoint now) {
+        deliveredBytes_ += payloadBytes;
+        latencies_.push_back(std::chrono::duration_cast<LinkReport::Duration>(now - sentAt));
+    }
+
+    //! Summarize over `elapsed` of virtual time
+    LinkReport report(std::chrono::nanoseconds elapsed) const {
+        LinkReport report;
+        report.messagesSent = sent_;
+        report.messagesDelivered = latencies_.size();
+        report.lossRate = sent_ == 0 ? 0 : 1.0 - static_cast<double>(latencies_.size()) / sent_;
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        report.goodputBitsPerSecond = seconds > 0 ? deliveredBytes_ * 8 / seconds : 0;
+
+        if (!latencies_.empty()) {
+            std::vector<LinkReport::Duration> sorted = latencies_;
+            std::sort(sorted.begin(), sorted.end());
+            //! Nearest-rank percentiles
+            auto percentile = [&](double p) {
+                size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+                return sorted[std::max<size_t>(rank, 1) - 1];
+            };
+            report.latencyP50 = percentile(0.50);
+            report.latencyP90 = percentile(0.90);
+            report.latencyP99 = percentile(0.99);
+            report.latencyMax = sorted.back();
+        }
+        return report;
+    }
+
+private:
+    uint64_t sent_ = 0;
+    uint64_t deliveredBytes_ = 0;
+    std::vector<LinkReport::Duration> latencies_;
+};
+
+} //! namespace serialflex
@@ -0,0 +1,417 @@
+#pragma once
+
+#include "serialflex.hpp"
+#include <system_error>
+#include <cerrno>
+#if !defined(__linux__)
+#error "serialflex_transport.hpp requires Linux (epoll)"
+#endif
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace serialflex {
+
+//! --------------------------------
+//! EPOLL TRANSPORT
+//! --------------------------------
+
+namespace detail {
+    [[noreturn]] inline void throwSystemError(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+}
+
+//! Put a serial TTY (or pty) into raw 8N1 mode so frame bytes pass unmodified.
+//! baud = 0 keeps the current line speed.
+inline void configureRawTty(int fd, speed_t baud = 0) {
+    termios tty;
+    if (::tcgetattr(fd, &tty) != 0) {
+        detail::throwSystemError("tcgetattr");
+    }
+    ::cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    if (baud != 0 && (::cfsetispeed(&tty, baud) != 0 || ::cfsetospeed(&tty, baud) != 0)) {
+        detail::throwSystemError("cfsetspeed");
+    }
+    if (::tcsetattr(fd, TCSANOW, &tty) != 0) {
+        detail::throwSystemError("tcsetattr");
+    }
+}
+
+//! Single-threaded, non-blocking I/O loop over many file descriptors (serial TTYs,
+//! pipes, UNIX sockets, ptys). Each link gets a PacketReceiver fed straight from
+//! chunked reads and a write queue that absorbs partial writes: send() writes what
+//! the kernel takes immediately and the rest goes out as the fd becomes writable.
+//! A link's fd may be read-only, write-only, or both (one pipe end is either).
+//!
+//! Driving the loop:
+//!   transport.poll(timeoutMs, [](size_t link, const DeframedPacket& packet) { ... });
+//!
+//! System call failures throw std::system_error; errors on a single link
+//! (EOF, hang-up, EPIPE) close that link and are reported to the close handler.
+//! Sockets are written with MSG_NOSIGNAL, but writing to a pipe or TTY whose
+//! reader is gone raises SIGPIPE: ignore it (signal(SIGPIPE, SIG_IGN)) in
+//! processes that send over pipes.
+class EpollTransport {
+public:
+    //! Default per-link cap on bytes waiting to be written
+    static constexpr size_t DEFAULT_MAX_QUEUED_BYTES = 1024 * 1024;
+    
+    //! Bytes read per read() call; one buffer is shared by all links
+    static constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+    
+    //! Events handled per epoll_wait call
+    static constexpr int MAX_EVENTS = 64;
+    
+    explicit EpollTransport(size_t maxPayloadSize = PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE,
+                            size_t maxQueuedBytes = DEFAULT_MAX_QUEUED_BYTES)
+        : epollFd_(::epoll_create1(EPOLL_CLOEXEC)), maxPayloadSize_(maxPayloadSize),
+          maxQueuedBytes_(maxQueuedBytes), readBuffer_(READ_CHUNK_SIZE), openLinks_(0) {
+        if (epollFd_ < 0) {
+            detail::throwSystemError("epoll_create1");
+        }
+    }
+    
+    EpollTransport(const EpollTransport&) = delete;
+    EpollTransport& operator=(const EpollTransport&) = delete;
+    
+    //! Closes every link whose fd the transport owns
+    ~EpollTransport() {
+        for (size_t link = 0; link < links_.size(); link++) {
+            if (links_[link]) {
+                release(link);
+            }
+        }
+        ::close(epollFd_);
+    }
+    
+    //! Register a file descriptor and return its link ID. The fd is switched to
+    //! non-blocking mode; with ownsFd the transport closes it when the link closes.
+    //! Link IDs are never reused, so events for a closed link cannot reach a new one.
+    size_t addLink(int fd, bool ownsFd = true) {
+        int flags = ::fcntl(fd, F_GETFL);
+        if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+            detail::throwSystemError("fcntl");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            detail::throwSystemError("fstat");
+        }
+        
+        size_t link = links_.size();
+        links_.push_back(std::make_unique<Link>(fd, ownsFd, S_ISSOCK(info.st_mode), maxPayloadSize_));
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = link;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            links_.pop_back();
+            detail::throwSystemError("epoll_ctl");
+        }
+        openLinks_++;
+        return link;
+    }
+    
+    //! Stop watching a link, dropping unsent data, and close its fd if owned
+    void removeLink(size_t link) {
+        if (isOpen(link)) {
+            release(link);
+        }
+    }
+    
+    //! Queue already framed bytes for transmission. Writes immediately when the
+    //! link's queue is empty; whatever the kernel does not take is kept and flushed
+    //! by poll(). Returns false without queuing anything when the link is closed or
+    //! the bytes would push its queue past maxQueuedBytes.
+    bool send(size_t link, ByteSpan bytes) {
+        return sendPieces(link, &bytes, 1);
+    }
+    
+    //! Frame and send a payload. When it needs no stuffing, header, payload and
+    //! trailer go out in one sendmsg/writev straight from the caller's memory, and
+    //! only what the kernel does not take right away is copied into the queue.
+    //! Payloads that need stuffing are framed into a scratch buffer as usual.
+    bool sendPayload(size_t link, uint8_t messageId, ByteSpan payload) {
+        PacketFramer::ScatterFrame frame;
+        if (!PacketFramer::frameScatter(frame, messageId, payload)) {
+            PacketFramer::framePacketInto(frameScratch_, messageId, payload);
+            return send(link, ByteSpan(frameScratch_));
+        }
+        const ByteSpan pieces[] = {ByteSpan(frame.header), frame.payload, ByteSpan(frame.trailer)};
+        return sendPieces(link, pieces, 3);
+    }
+    
+    //! Serialize, frame and send a message
+    template<typename T>
+    bool sendMessage(size_t link, uint8_t messageId, const T& data) {
+        return sendPayload(link, messageId, ByteSpan(serialize(data)));
+    }
+    
+    //! Wait up to timeoutMs (-1 = forever, 0 = don't block) for I/O, then read and
+    //! flush every ready link. onPacket(size_t link, const DeframedPacket&) is called
+    //! for every frame, valid or not; onClose(size_t link) when a link shuts down.
+    //! Handlers may call send() and removeLink(). Returns the number of events handled.
+    template<typename OnPacket, typename OnClose>
+    size_t poll(int timeoutMs, OnPacket&& onPacket, OnClose&& onClose) {
+        epoll_event events[MAX_EVENTS];
+        int count = ::epoll_wait(epollFd_, events, MAX_EVENTS, closing_.empty() ? timeoutMs : 0);
+        if (count < 0) {
+            if (errno != EINTR) {
+                detail::throwSystemError("epoll_wait");
+            }
+            count = 0;
+        }
+        
+        for (int i = 0; i < count; i++) {
+            size_t link = static_cast<size_t>(events[i].data.u64);
+            uint32_t ready = events[i].events;
+            
+            if ((ready & EPOLLOUT) && isOpen(link)) {
+                flush(link);
+            }
+            if ((ready & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && isOpen(link)) {
+                readAvailable(link, onPacket);
+            }
+        }
+        
+        //! Links that failed here or in send() since the last poll
+        size_t closed = closing_.size();
+        for (size_t i = 0; i < closing_.size(); i++) {
+            size_t link = closing_[i];
+            if (links_[link]) {
+                onClose(link);
+                release(link);
+            }
+        }
+        closing_.clear();
+        return static_cast<size_t>(count) + closed;
+    }
+    
+    template<typename OnPacket>
+    size_t poll(int timeoutMs, OnPacket&& onPacket) {
+        return poll(timeoutMs, std::forward<OnPacket>(onPacket), [](size_t) {});
+    }
+    
+    //! Link is registered and has not hit EOF or an error
+    bool isOpen(size_t link) const {
+        return link < links_.size() && links_[link] && !links_[link]->closed;
+    }
+    
+    //! Bytes accepted by send() but not yet written
+    size_t queuedBytes(size_t link) const {
+        return link < links_.size() && links_[link] ? links_[link]->queuedBytes() : 0;
+    }
+    
+    size_t openLinkCount() const {
+        return openLinks_;
+    }
+    
+    int fd(size_t link) const {
+        return links_[link]->fd;
+    }
+
+private:
+    //! Most pieces one send gathers: header, payload and trailer
+    static constexpr size_t MAX_PIECES = 3;
+    
+    struct Link {
+        Link(int fd, bool ownsFd, bool isSocket, size_t maxPayloadSize)
+            : fd(fd), ownsFd(ownsFd), isSocket(isSocket), receiver(maxPayloadSize) {}
+        
+        size_t queuedBytes() const {
+            return queue.size() - queueHead;
+        }
+        
+        int fd;
+        bool ownsFd;
+        bool isSocket;              //! Decided once in addLink(), so writes need one syscall
+        bool closed = false;
+        bool watchingWritable = false;
+        PacketReceiver receiver;
+        DeframedPacket packet;
+        std::vector<uint8_t> queue; //! Unsent bytes from queueHead on
+        size_t queueHead = 0;
+    };
+    
+    //! Write as much of the pieces as the kernel takes, gathering them into one
+    //! call per attempt. written counts bytes across all pieces.
+    static bool writeSome(Link& state, const ByteSpan* pieces, size_t count, size_t& written) {
+        iovec iov[MAX_PIECES];
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            iov[i].iov_base = const_cast<uint8_t*>(pieces[i].data());
+            iov[i].iov_len = pieces[i].size();
+            total += pieces[i].size();
+        }
+        
+        size_t first = 0;
+        size_t advanced = 0;
+        while (written < total) {
+            //! Skip whatever earlier rounds wrote
+            for (; advanced < written; first++) {
+                size_t step = std::min(iov[first].iov_len, written - advanced);
+                iov[first].iov_base = static_cast<uint8_t*>(iov[first].iov_base) + step;
+                iov[first].iov_len -= step;
+                advanced += step;
+                if (iov[first].iov_len > 0) {
+                    break;
+                }
+            }
+            
+            //! sendmsg() avoids SIGPIPE on sockets; pipes and TTYs need plain writev()
+            ssize_t n;
+            if (state.isSocket) {
+                msghdr message{};
+                message.msg_iov = iov + first;
+                message.msg_iovlen = count - first;
+                n = ::sendmsg(state.fd, &message, MSG_NOSIGNAL);
+            } else {
+                n = ::writev(state.fd, iov + first, static_cast<int>(count - first));
+            }
+            if (n > 0) {
+                written += static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return true;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    //! Send consecutive pieces of framed bytes, queuing whatever is not written
+    bool sendPieces(size_t link, const ByteSpan* pieces, size_t count) {
+        if (!isOpen(link)) {
+            return false;
+        }
+        Link& state = *links_[link];
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            total += pieces[i].size();
+        }
+        if (state.queuedBytes() + total > maxQueuedBytes_) {
+            return false;
+        }
+        
+        size_t written = 0;
+        if (state.queuedBytes() == 0) {
+            if (!writeSome(state, pieces, count, written)) {
+                closeLink(link);
+                return false;
+            }
+            if (written == total) {
+                return true;
+            }
+        }
+        
+        for (size_t i = 0; i < count; i++) {
+            size_t skip = std::min(written, pieces[i].size());
+            state.queue.insert(state.queue.end(), pieces[i].begin() + skip, pieces[i].end());
+            written -= skip;
+        }
+        watchWritable(link, true);
+        return true;
+    }
+    
+    void flush(size_t link) {
+        Link& state = *links_[link];
+        size_t written = 0;
+        ByteSpan pending(state.queue.data() + state.queueHead, state.queuedBytes());
+        if (!writeSome(state, &pending, 1, written)) {
+            closeLink(link);
+            return;
+        }
+        state.queueHead += written;
+        
+        if (state.queuedBytes() == 0) {
+            state.queue.clear();
+            state.queueHead = 0;
+            watchWritable(link, false);
+        } else if (state.queueHead > state.queue.size() / 2) {
+            //! Compact once the sent prefix dominates, so the queue cannot grow without bound
+            state.queue.erase(state.queue.begin(), state.queue.begin() + static_cast<ptrdiff_t>(state.queueHead));
+            state.queueHead = 0;
+        }
+    }
+    
+    //! Read until the fd would block, bounded so one busy link cannot starve the rest
+    template<typename OnPacket>
+    void readAvailable(size_t link, OnPacket& onPacket) {
+        constexpr int READS_PER_EVENT = 4;
+        for (int i = 0; i < READS_PER_EVENT && isOpen(link); i++) {
+            Link& state = *links_[link];
+            ssize_t n = ::read(state.fd, readBuffer_.data(), readBuffer_.size());
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            if (n <= 0) {
+                closeLink(link); //! EOF or read error
+                return;
+            }
+            
+            for (ssize_t j = 0; j < n; j++) {
+                if (state.receiver.processByte(readBuffer_[static_cast<size_t>(j)], state.packet)) {
+                    onPacket(link, static_cast<const DeframedPacket&>(state.packet));
+                    if (!isOpen(link)) {
+                        return; //! Removed by the handler
+                    }
+                }
+            }
+            if (static_cast<size_t>(n) < readBuffer_.size()) {
+                return;
+            }
+        }
+    }
+    
+    void watchWritable(size_t link, bool enable) {
+        Link& state = *links_[link];
+        if (state.watchingWritable == enable) {
+            return;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | (enable ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        event.data.u64 = link;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_MOD, state.fd, &event) != 0) {
+            detail::throwSystemError("epoll_ctl");
+        }
+        state.watchingWritable = enable;
+    }
+    
+    //! Mark a link dead; the next poll() reports and releases it
+    void closeLink(size_t link) {
+        links_[link]->closed = true;
+        closing_.push_back(link);
+    }
+    
+    void release(size_t link) {
+        Link& state = *links_[link];
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, state.fd, nullptr);
+        if (state.ownsFd) {
+            ::close(state.fd);
+        }
+        links_[link].reset();
+        openLinks_--;
+    }
+    
+    int epollFd_;
+    size_t maxPayloadSize_;
+    size_t maxQueuedBytes_;
+    std::vector<uint8_t> readBuffer_;
+    std::vector<uint8_t> frameScratch_;
+    std::vector<std::unique_ptr<Link>> links_;
+    std::vector<size_t> closing_;
+    size_t openLinks_;
+};
+
+} //! namespace serialflex
@@ -0,0 +1,701 @@
+#pragma once
+
+#include "serialflex.hpp"
+#include "serialflex_queue.hpp"
+#include "serialflex_transport.hpp"
+#include <deque>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+namespace serialflex {
+
+//! --------------------------------
+//! IO_URING TRANSPORT
+//! --------------------------------
+
+namespace detail {
+    //! The ring indices live in memory shared with the kernel
+    inline uint32_t loadAcquire(const uint32_t* index) {
+        return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+    }
+    
+    inline void storeRelease(uint32_t* index, uint32_t value) {
+        __atomic_store_n(index, value, __ATOMIC_RELEASE);
+    }
+    
+    inline int uringSetup(unsigned entries, io_uring_params* params) {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+    
+    inline int uringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags,
+                          const void* arg, size_t argSize) {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, arg, argSize));
+    }
+    
+    inline int uringRegister(int ringFd, unsigned opcode, const void* arg, unsigned count) {
+        return static_cast<int>(::syscall(__NR_io_uring_register, ringFd, opcode, arg, count));
+    }
+}
+
+//! io_uring alternative to EpollTransport with the same link/send/poll interface.
+//! Talks to the kernel directly (no liburing) and needs Linux 5.11 or newer.
+//!
+//! Receive: every link keeps one read in flight that picks its buffer from a
+//! provided buffer group shared by all links, so idle links pin no memory. Frames
+//! are decoded straight out of the kernel-filled buffer, which then goes back to
+//! the group.
+//!
+//! Transmit: each link owns a slice of one registered send arena. send() copies
+//! framed bytes into that slice, and poll() submits everything queued as a chain
+//! of linked WRITE_FIXED operations cut at frame boundaries. Linking keeps the
+//! writes ordered without waiting for each completion; if a write comes up short,
+//! the kernel cancels the rest of the chain and the unsent bytes are resubmitted.
+//!
+//! One poll() is one io_uring_enter call that submits the queued work and
+//! waits for completions, instead of an epoll_wait plus a read or write per link.
+class UringTransport {
+public:
+    //! Registered send memory per link; bounds the bytes queued on one link
+    static constexpr size_t DEFAULT_SEND_BUFFER_SIZE = 64 * 1024;
+    
+    //! Provided receive buffers shared by all links; use at least one per busy link
+    static constexpr size_t DEFAULT_RECEIVE_BUFFER_COUNT = 256;
+    static constexpr size_t DEFAULT_RECEIVE_BUFFER_SIZE = 4096;
+    
+    //! Largest single write in a send chain; whole frames are never split below this
+    static constexpr size_t WRITE_PIECE_SIZE = 16 * 1024;
+    
+    //! Writes per chain; the rest of a link's queue follows in the next chain
+    static constexpr size_t MAX_CHAIN_LENGTH = 16;
+    
+    explicit UringTransport(size_t maxLinks,
+                            size_t maxPayloadSize = PacketReceiver::DEFAULT_MAX_PAYLOAD_SIZE,
+                            size_t sendBufferSize = DEFAULT_SEND_BUFFER_SIZE,
+                            size_t receiveBufferCount = DEFAULT_RECEIVE_BUFFER_COUNT,
+                            size_t receiveBufferSize = DEFAULT_RECEIVE_BUFFER_SIZE)
+        : maxPayloadSize_(maxPayloadSize), sendBufferSize_(sendBufferSize),
+          receiveBufferCount_(receiveBufferCount),
+          receiveBufferSize_(receiveBufferSize), openLinks_(0) {
+        if (maxLinks == 0 || maxLinks > UINT32_MAX || sendBufferSize == 0 || sendBufferSize > UINT32_MAX) {
+            throw std::invalid_argument("Link count or send buffer size out of range");
+        }
+        if (receiveBufferCount == 0 || receiveBufferCount > 65536 || receiveBufferSize == 0 ||
+            receiveBufferSize > UINT32_MAX) {
+            throw std::invalid_argument("Receive buffer count or size out of range");
+        }
+        
+        try {
+            setupRing(static_cast<unsigned>(detail::roundUpToPowerOfTwo(std::min<size_t>(std::max<size_t>(maxLinks * 2, 64), 4096))));
+            setupReceiveBuffers();
+            setupSendArena(maxLinks);
+        } catch (...) {
+            teardown();
+            throw;
+        }
+    }
+    
+    UringTransport(const UringTransport&) = delete;
+    UringTransport& operator=(const UringTransport&) = delete;
+    
+    //! Closes every link whose fd the transport owns
+    ~UringTransport() {
+        teardown();
+    }
+    
+    //! Register a file descriptor and return its link ID. With ownsFd the transport
+    //! closes it once the link is gone. Link IDs are never reused.
+    size_t addLink(int fd, bool ownsFd = true) {
+        if (freeSlots_.empty()) {
+            throw std::length_error("Transport link limit reached");
+        }
+        
+        size_t link = links_.size();
+        links_.push_back(std::make_unique<Link>(fd, ownsFd, freeSlots_.back(), maxPayloadSize_));
+        freeSlots_.pop_back();
+        openLinks_++;
+        if ((::fcntl(fd, F_GETFL) & O_ACCMODE) != O_WRONLY) {
+            armRead(link); //! Write-only links (pipe write ends) learn of hang-ups from failed writes
+        }
+        return link;
+    }
+    
+    //! Stop using a link, dropping unsent data. The fd is closed (if owned) once the
+    //! kernel has finished with it.
+    void removeLink(size_t link) {
+        if (isOpen(link)) {
+            beginClose(link, false);
+        }
+    }
+    
+    //! Queue already framed bytes; they are submitted by the next poll() or submit().
+    //! Returns false without queuing anything when the link is closed or its send
+    //! buffer cannot take the bytes yet.
+    bool send(size_t link, ByteSpan bytes) {
+        if (!isOpen(link)) {
+            return false;
+        }
+        Link& state = *links_[link];
+        if (state.writePos + bytes.size() > sendBufferSize_) {
+            if (state.chain.empty()) {
+                compact(state);
+            }
+            if (state.writePos + bytes.size() > sendBufferSize_) {
+                return false;
+            }
+        }
+        
+        if (!bytes.empty()) {
+            std::memcpy(sendSlot(state) + state.writePos, bytes.data(), bytes.size());
+            state.writePos += static_cast<uint32_t>(bytes.size());
+            state.frameEnds.push_back(state.writePos);
+            markDirty(link);
+        }
+        return true;
+    }
+    
+    //! Serialize, frame and queue a message
+    template<typename T>
+    bool sendMessage(size_t link, uint8_t messageId, const T& data) {
+        PacketFramer::framePacketInto(frameScratch_, messageId, ByteSpan(serialize(data)));
+        return send(link, ByteSpan(frameScratch_));
+    }
+    
+    //! Submit queued sends without waiting for anything
+    void submit() {
+        flushDirty();
+        enter(0, -1);
+    }
+    
+    //! Submit queued work and wait up to timeoutMs (-1 = forever, 0 = don't block)
+    //! for completions. onPacket(size_t link, const DeframedPacket&) is called for
+    //! every frame, valid or not; onClose(size_t link) when a link fails (EOF,
+    //! hang-up, write error). Handlers may call send() and removeLink().
+    //! Returns the number of completions handled.
+    template<typename OnPacket, typename OnClose>
+    size_t poll(int timeoutMs, OnPacket&& onPacket, OnClose&& onClose) {
+        flushDirty();
+        enter(timeoutMs == 0 ? 0 : 1, timeoutMs);
+        
+        //! Reads re-armed on busy links usually complete during submission, so a
+        //! few extra non-blocking rounds drain them without another wait
+        size_t handled = 0;
+        for (int round = 0; round < REAP_ROUNDS; round++) {
+            size_t reaped = reapCompletions(onPacket);
+            handled += reaped;
+            if (reaped == 0 || round + 1 == REAP_ROUNDS) {
+                break;
+            }
+            flushDirty();
+            enter(0, -1);
+        }
+        
+        for (size_t link : rearm_) {
+            if (isOpen(link) && !links_[link]->readArmed) {
+                armRead(link);
+            }
+        }
+        rearm_.clear();
+        
+        finishClosing(onClose);
+        return handled;
+    }
+    
+    template<typename OnPacket>
+    size_t poll(int timeoutMs, OnPacket&& onPacket) {
+        return poll(timeoutMs, std::forward<OnPacket>(onPacket), [](size_t) {});
+    }
+    
+    //! Link is registered and has not failed or been removed
+    bool isOpen(size_t link) const {
+        return link < links_.size() && links_[link] && !links_[link]->closing;
+    }
+    
+    //! Bytes accepted by send() but not yet confirmed written
+    size_t queuedBytes(size_t link) const {
+        return link < links_.size() && links_[link] ? links_[link]->writePos - links_[link]->sentPos : 0;
+    }
+    
+    size_t openLinkCount() const {
+        return openLinks_;
+    }
+    
+    int fd(size_t link) const {
+        return links_[link]->fd;
+    }
+
+private:
+    //! Submit-and-reap rounds per poll() once the first wait has returned
+    static constexpr int REAP_ROUNDS = 4;
+    
+    enum class Op : uint64_t {
+        Provide = 0,
+        Read = 1,
+        Write = 2,
+        Cancel = 3
+    };
+    
+    //! A write of [offset, offset + length) within the link's send slot
+    struct Piece {
+        uint32_t offset;
+        uint32_t length;
+    };
+    
+    struct Link {
+        Link(int fd, bool ownsFd, uint32_t slot, size_t maxPayloadSize)
+            : fd(fd), ownsFd(ownsFd), slot(slot), receiver(maxPayloadSize) {}
+        
+        int fd;
+        bool ownsFd;
+        uint32_t slot;               //! Index of the link's slice of the send arena
+        PacketReceiver receiver;
+        DeframedPacket packet;
+        
+        bool readArmed = false;
+        bool dirty = false;          //! Has queued bytes not yet submitted
+        bool closing = false;
+        bool reportClose = false;
+        uint32_t outstanding = 0;    //! Submitted operations not yet completed
+        
+        //! Send slot layout: [0, sentPos) written, [sentPos, chainEnd) in flight,
+        //! [chainEnd, writePos) queued
+        uint32_t sentPos = 0;
+        uint32_t chainEnd = 0;
+        uint32_t writePos = 0;
+        std::deque<uint32_t> frameEnds; //! End offsets of frames not yet fully written
+        std::vector<Piece> chain;       //! Writes of the chain in flight
+        uint32_t chainDone = 0;
+        uint32_t unsentFrom = 0;        //! First byte a short or cancelled write left behind
+    };
+    
+    static uint64_t userData(size_t link, Op op, size_t index = 0) {
+        return (static_cast<uint64_t>(link) << 16) | (static_cast<uint64_t>(index) << 2) | static_cast<uint64_t>(op);
+    }
+    
+    void setupRing(unsigned entries) {
+        io_uring_params params{};
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 4;
+        ringFd_ = detail::uringSetup(entries, &params);
+        if (ringFd_ < 0) {
+            detail::throwSystemError("io_uring_setup");
+        }
+        if (!(params.features & IORING_FEAT_EXT_ARG)) {
+            throw std::runtime_error("io_uring is missing required features (Linux 5.11+ needed)");
+        }
+        
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        singleMmap_ = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap_) {
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        }
+        
+        sqRing_ = mapRing(sqRingSize_, IORING_OFF_SQ_RING);
+        cqRing_ = singleMmap_ ? sqRing_ : mapRing(cqRingSize_, IORING_OFF_CQ_RING);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mapRing(sqesSize_, IORING_OFF_SQES));
+        
+        uint8_t* sq = static_cast<uint8_t*>(sqRing_);
+        sqHead_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+        sqEntries_ = params.sq_entries;
+        
+        uint8_t* cq = static_cast<uint8_t*>(cqRing_);
+        cqHead_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        
+        sqLocalTail_ = *sqTail_;
+    }
+    
+    template<typename OnPacket>
+    size_t reapCompletions(OnPacket& onPacket) {
+        size_t reaped = 0;
+        uint32_t head = *cqHead_;
+        uint32_t tail = detail::loadAcquire(cqTail_);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes_[head & cqMask_];
+            complete(cqe.user_data, cqe.res, cqe.flags, onPacket);
+            reaped++;
+            head++;
+            if (head == tail) {
+                detail::storeRelease(cqHead_, head);
+                tail = detail::loadAcquire(cqTail_);
+            }
+        }
+        detail::storeRelease(cqHead_, head);
+        return reaped;
+    }
+    
+    void* mapRing(size_t size, off_t offset) {
+        void* ring = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, offset);
+        if (ring == MAP_FAILED) {
+            detail::throwSystemError("mmap");
+        }
+        return ring;
+    }
+    
+    //! Hand the whole receive pool to the kernel as buffer group 0; a buffer-select
+    //! read takes one buffer from it and the buffer ID comes back in the completion
+    void setupReceiveBuffers() {
+        receivePool_.resize(receiveBufferCount_ * receiveBufferSize_);
+        provideBuffers(0, receiveBufferCount_);
+        enter(1, -1);
+        
+        const io_uring_cqe& cqe = cqes_[*cqHead_ & cqMask_];
+        if (cqe.res < 0) {
+            errno = -cqe.res;
+            detail::throwSystemError("io_uring PROVIDE_BUFFERS");
+        }
+        detail::storeRelease(cqHead_, *cqHead_ + 1);
+    }
+    
+    //! One registered buffer covering every link's send slot, for WRITE_FIXED
+    void setupSendArena(size_t maxLinks) {
+        sendArena_.resize(maxLinks * sendBufferSize_);
+        iovec arena{sendArena_.data(), sendArena_.size()};
+        if (detail::uringRegister(ringFd_, IORING_REGISTER_BUFFERS, &arena, 1) != 0) {
+            detail::throwSystemError("io_uring_register(BUFFERS)");
+        }
+        for (size_t slot = maxLinks; slot > 0; slot--) {
+            freeSlots_.push_back(static_cast<uint32_t>(slot - 1));
+        }
+    }
+    
+    void teardown() {
+        for (size_t link = 0; link < links_.size(); link++) {
+            if (links_[link] && links_[link]->ownsFd) {
+                ::close(links_[link]->fd);
+            }
+        }
+        links_.clear();
+        if (ringFd_ >= 0) {
+            ::close(ringFd_); //! Cancels everything in flight and releases the buffers
+            ringFd_ = -1;
+        }
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqesSize_);
+            sqes_ = nullptr;
+        }
+        if (cqRing_ != nullptr && !singleMmap_) {
+            ::munmap(cqRing_, cqRingSize_);
+        }
+        if (sqRing_ != nullptr) {
+            ::munmap(sqRing_, sqRingSize_);
+        }
+        sqRing_ = cqRing_ = nullptr;
+    }
+    
+    //! Return buffers [firstId, firstId + count) to the group. Runs inline when
+    //! submitted, so a read queued after it can already use them.
+    void provideBuffers(size_t firstId, size_t count) {
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = static_cast<int>(count);
+        sqe->addr = reinterpret_cast<uint64_t>(receivePool_.data() + firstId * receiveBufferSize_);
+        sqe->len = static_cast<uint32_t>(receiveBufferSize_);
+        sqe->off = firstId;
+        sqe->buf_group = 0;
+        sqe->user_data = userData(0, Op::Provide);
+    }
+    
+    //! Next free submission entry, flushing the queue to the kernel if it is full
+    io_uring_sqe* nextSqe() {
+        if (sqLocalTail_ - detail::loadAcquire(sqHead_) == sqEntries_) {
+            enter(0, -1);
+        }
+        uint32_t index = sqLocalTail_ & sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray_[index] = index;
+        sqLocalTail_++;
+        return sqe;
+    }
+    
+    size_t freeSqes() const {
+        return sqEntries_ - (sqLocalTail_ - detail::loadAcquire(sqHead_));
+    }
+    
+    //! Publish queued entries and, with minComplete > 0, wait for completions
+    void enter(unsigned minComplete, int timeoutMs) {
+        detail::storeRelease(sqTail_, sqLocalTail_);
+        unsigned toSubmit = sqLocalTail_ - sqSubmitted_;
+        if (toSubmit == 0 && minComplete == 0) {
+            return;
+        }
+        
+        __kernel_timespec timeout{};
+        io_uring_getevents_arg arg{};
+        if (timeoutMs > 0) {
+            timeout.tv_sec = timeoutMs / 1000;
+            timeout.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+            arg.ts = reinterpret_cast<uint64_t>(&timeout);
+        }
+        unsigned flags = IORING_ENTER_EXT_ARG | (minComplete > 0 ? IORING_ENTER_GETEVENTS : 0);
+        
+        int submitted = detail::uringEnter(ringFd_, toSubmit, minComplete, flags, &arg, sizeof(arg));
+        if (submitted < 0) {
+            if (errno != EINTR && errno != ETIME && errno != EBUSY && errno != EAGAIN) {
+                detail::throwSystemError("io_uring_enter");
+            }
+            submitted = 0;
+        }
+        sqSubmitted_ += static_cast<uint32_t>(submitted);
+    }
+    
+    void armRead(size_t link) {
+        Link& state = *links_[link];
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = state.fd;
+        sqe->off = static_cast<uint64_t>(-1); //! Current file position; required for pipes and sockets
+        sqe->len = static_cast<uint32_t>(receiveBufferSize_);
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+        sqe->user_data = userData(link, Op::Read);
+        state.readArmed = true;
+        state.outstanding++;
+    }
+    
+    void markDirty(size_t link) {
+        Link& state = *links_[link];
+        if (!state.dirty) {
+            state.dirty = true;
+            dirty_.push_back(link);
+        }
+    }
+    
+    void flushDirty() {
+        for (size_t i = 0; i < dirty_.size(); i++) {
+            size_t link = dirty_[i];
+            if (links_[link]) {
+                links_[link]->dirty = false;
+                if (isOpen(link)) {
+                    submitChain(link);
+                }
+            }
+        }
+        dirty_.clear();
+    }
+    
+    //! Submit the queued bytes as linked writes, each ending on a frame boundary
+    void submitChain(size_t link) {
+        Link& state = *links_[link];
+        if (!state.chain.empty() || state.chainEnd == state.writePos) {
+            return;
+        }
+        
+        uint32_t pos = state.chainEnd;
+        uint32_t pieceStart = pos;
+        for (uint32_t frameEnd : state.frameEnds) {
+            if (frameEnd <= pos) {
+                continue;
+            }
+            if (frameEnd - pieceStart > WRITE_PIECE_SIZE && pos > pieceStart) {
+                state.chain.push_back({pieceStart, pos - pieceStart});
+                pieceStart = pos;
+                if (state.chain.size() == MAX_CHAIN_LENGTH) {
+                    break;
+                }
+            }
+            pos = frameEnd;
+        }
+        if (pos > pieceStart && state.chain.size() < MAX_CHAIN_LENGTH) {
+            state.chain.push_back({pieceStart, pos - pieceStart});
+        }
+        
+        //! A chain must reach the kernel in one submission, or the link is cut short
+        if (freeSqes() < state.chain.size()) {
+            enter(0, -1);
+        }
+        
+        for (size_t i = 0; i < state.chain.size(); i++) {
+            const Piece& piece = state.chain[i];
+            io_uring_sqe* sqe = nextSqe();
+            sqe->opcode = IORING_OP_WRITE_FIXED;
+            sqe->fd = state.fd;
+            sqe->off = static_cast<uint64_t>(-1);
+            sqe->addr = reinterpret_cast<uint64_t>(sendSlot(state) + piece.offset);
+            sqe->len = piece.length;
+            sqe->buf_index = 0;
+            sqe->flags = i + 1 < state.chain.size() ? IOSQE_IO_LINK : 0;
+            sqe->user_data = userData(link, Op::Write, i);
+        }
+        
+        state.outstanding += static_cast<uint32_t>(state.chain.size());
+        state.chainDone = 0;
+        state.chainEnd = state.chain.back().offset + state.chain.back().length;
+        state.unsentFrom = state.chainEnd;
+        if (state.chainEnd < state.writePos) {
+            markDirty(link); //! Chain was capped; the rest follows after it completes
+        }
+    }
+    
+    template<typename OnPacket>
+    void complete(uint64_t data, int32_t result, uint32_t flags, OnPacket& onPacket) {
+        Op op = static_cast<Op>(data & 3);
+        size_t link = static_cast<size_t>(data >> 16);
+        if (op == Op::Cancel || op == Op::Provide || link >= links_.size() || !links_[link]) {
+            return;
+        }
+        Link& state = *links_[link];
+        state.outstanding--;
+        
+        if (op == Op::Read) {
+            state.readArmed = false;
+            if (result > 0 && (flags & IORING_CQE_F_BUFFER)) {
+                uint16_t bufferId = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+                const uint8_t* bytes = receivePool_.data() + static_cast<size_t>(bufferId) * receiveBufferSize_;
+                for (int32_t i = 0; i < result && isOpen(link); i++) {
+                    if (state.receiver.processByte(bytes[i], state.packet)) {
+                        onPacket(link, static_cast<const DeframedPacket&>(state.packet));
+                    }
+                }
+                provideBuffers(bufferId, 1);
+                if (isOpen(link)) {
+                    armRead(link);
+                }
+            } else if (result == -ENOBUFS || result == -EAGAIN || result == -EINTR) {
+                rearm_.push_back(link); //! Retry once this batch has returned its buffers
+            } else if (result != -ECANCELED) {
+                beginClose(link, true); //! EOF or read error
+            }
+            return;
+        }
+        
+        //! Write: a short or cancelled piece leaves everything from there on unsent
+        const Piece& piece = state.chain[(data >> 2) & 0x3FFF];
+        if (result >= 0 && static_cast<uint32_t>(result) < piece.length) {
+            state.unsentFrom = std::min(state.unsentFrom, piece.offset + static_cast<uint32_t>(result));
+        } else if (result < 0) {
+            state.unsentFrom = std::min(state.unsentFrom, piece.offset);
+            if (result != -ECANCELED && result != -EAGAIN && result != -EINTR) {
+                beginClose(link, true);
+            }
+        }
+        if (++state.chainDone == state.chain.size()) {
+            finishChain(link);
+        }
+    }
+    
+    void finishChain(size_t link) {
+        Link& state = *links_[link];
+        state.sentPos = state.unsentFrom;
+        state.chainEnd = state.sentPos;
+        state.chain.clear();
+        while (!state.frameEnds.empty() && state.frameEnds.front() <= state.sentPos) {
+            state.frameEnds.pop_front();
+        }
+        if (state.sentPos == state.writePos) {
+            state.sentPos = state.chainEnd = state.writePos = 0;
+        } else {
+            markDirty(link);
+        }
+    }
+    
+    //! Move unsent bytes to the front of the slot; only while no chain is in flight
+    void compact(Link& state) {
+        if (state.sentPos == 0) {
+            return;
+        }
+        uint8_t* slot = sendSlot(state);
+        std::memmove(slot, slot + state.sentPos, state.writePos - state.sentPos);
+        for (uint32_t& frameEnd : state.frameEnds) {
+            frameEnd -= state.sentPos;
+        }
+        state.writePos -= state.sentPos;
+        state.chainEnd -= state.sentPos;
+        state.sentPos = 0;
+    }
+    
+    uint8_t* sendSlot(const Link& state) {
+        return sendArena_.data() + static_cast<size_t>(state.slot) * sendBufferSize_;
+    }
+    
+    //! Cancel everything in flight on the link; it is released once all of it completes
+    void beginClose(size_t link, bool report) {
+        Link& state = *links_[link];
+        if (state.closing) {
+            return;
+        }
+        state.closing = true;
+        state.reportClose = report;
+        closing_.push_back(link);
+        
+        if (state.outstanding > 0) {
+            io_uring_sqe* sqe = nextSqe();
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = state.fd;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+            sqe->user_data = userData(link, Op::Cancel);
+        }
+    }
+    
+    template<typename OnClose>
+    void finishClosing(OnClose& onClose) {
+        size_t kept = 0;
+        for (size_t i = 0; i < closing_.size(); i++) {
+            size_t link = closing_[i];
+            Link& state = *links_[link];
+            if (state.reportClose) {
+                state.reportClose = false;
+                onClose(link);
+            }
+            if (state.outstanding > 0) {
+                closing_[kept++] = link; //! Kernel still owns buffers of this link
+                continue;
+            }
+            if (state.ownsFd) {
+                ::close(state.fd);
+            }
+            freeSlots_.push_back(state.slot);
+            links_[link].reset();
+            openLinks_--;
+        }
+        closing_.resize(kept);
+    }
+    
+    size_t maxPayloadSize_;
+    size_t sendBufferSize_;
+    size_t receiveBufferCount_;
+    size_t receiveBufferSize_;
+    
+    int ringFd_ = -1;
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqRingSize_ = 0;
+    size_t cqRingSize_ = 0;
+    size_t sqesSize_ = 0;
+    bool singleMmap_ = false;
+    uint32_t* sqHead_ = nullptr;
+    uint32_t* sqTail_ = nullptr;
+    uint32_t* sqArray_ = nullptr;
+    uint32_t sqMask_ = 0;
+    uint32_t sqEntries_ = 0;
+    uint32_t sqLocalTail_ = 0;   //! Entries filled in, published to the kernel by enter()
+    uint32_t sqSubmitted_ = 0;   //! Entries the kernel has accepted
+    uint32_t* cqHead_ = nullptr;
+    uint32_t* cqTail_ = nullptr;
+    uint32_t cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    
+    std::vector<uint8_t> receivePool_;
+    
+    std::vector<uint8_t> sendArena_;
+    std::vector<uint32_t> freeSlots_;
+    std::vector<uint8_t> frameScratch_;
+    
+    std::vector<std::unique_ptr<Link>> links_;
+    std::vector<size_t> dirty_;
+    std::vector<size_t> rearm_;
+    std::vector<size_t> closing_;
+    size_t openLinks_;
+};
+
+} //! namespace serialflex